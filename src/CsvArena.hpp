@@ -0,0 +1,118 @@
+/*
+ * File:   CsvArena.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVARENA_HPP
+#define CSVARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace csvh {
+
+    /**
+     * Monotonic buffer for objects living as long as a loaded chunk.
+     * Memory is taken from blocks growing twice in size, single objects
+     * are never freed. reset makes all blocks available again without
+     * returning them to the system, so the next chunk reuses them.
+     * Destructors are not called by the arena.
+     */
+    class CsvArena {
+    public:
+
+        CsvArena() : _currentBlock(0), _used(0) {
+        }
+
+        /**
+         * Method is used to allocate memory from the arena.
+         *
+         * @param size
+         * @param alignment - power of two
+         * @return memory valid until reset or arena destruction
+         */
+        void* allocate(size_t size, size_t alignment) {
+            while (_currentBlock < _blocks.size()) {
+                size_t offset = (_used + alignment - 1) & ~(alignment - 1);
+                if (offset + size <= _blocks[_currentBlock].size) {
+                    _used = offset + size;
+                    return _blocks[_currentBlock].data.get() + offset;
+                }
+                ++_currentBlock;
+                _used = 0;
+            }
+            size_t blockSize = _blocks.empty() ? _firstBlockSize
+                    : _blocks.back().size * 2;
+            if (blockSize > _maxBlockSize) blockSize = _maxBlockSize;
+            if (blockSize < size + alignment) blockSize = size + alignment;
+            Block block = {std::unique_ptr<char[]>(new char[blockSize]), blockSize};
+            _blocks.push_back(std::move(block));
+            _currentBlock = _blocks.size() - 1;
+            return allocate(size, alignment);
+        }
+
+        /**
+         * Method is used to construct object in the arena.
+         *
+         * @return new object, destructor has to be called by the owner
+         */
+        template <class T, class... Args>
+        T* create(Args&&... args) {
+            return new (allocate(sizeof (T), alignof (T)))
+                    T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * Method is used to release all objects at once.
+         * Blocks are kept for next allocations.
+         */
+        void reset() {
+            _currentBlock = 0;
+            _used = 0;
+        }
+
+        /**
+         * Method returns bytes allocated by the arena.
+         *
+         * @return memory usage
+         */
+        long long getMemoryUsage() const {
+            long long memory = 0;
+            for (const Block& block : _blocks) memory += block.size;
+            return memory;
+        }
+
+        /**
+         * Method returns bytes of arena blocks taken by objects since
+         * the last reset, unused tails of skipped blocks included.
+         *
+         * @return used memory
+         */
+        long long getUsedMemory() const {
+            long long memory = _used;
+            for (size_t block = 0; block < _currentBlock; ++block) {
+                memory += _blocks[block].size;
+            }
+            return memory;
+        }
+
+    private:
+
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t size;
+        };
+
+        static const size_t _firstBlockSize = 64 * 1024;
+        static const size_t _maxBlockSize = 64 * 1024 * 1024;
+
+        std::vector<Block> _blocks;
+        size_t _currentBlock;
+        size_t _used;
+    };
+}
+
+#endif /* CSVARENA_HPP */
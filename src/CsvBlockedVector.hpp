@@ -0,0 +1,254 @@
+/*
+ * File:   CsvBlockedVector.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVBLOCKEDVECTOR_HPP
+#define CSVBLOCKEDVECTOR_HPP
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace csvh {
+
+    /**
+     * Sequence kept in blocks of up to 64K elements with index of first
+     * element of every block. Inserting in the middle shifts elements of
+     * one block only, a block growing twice over the limit is split.
+     * Element lookup is O(1) while all blocks except the last are full,
+     * e.g. after loading, and O(log blocks) after inserts.
+     */
+    template <class T>
+    class CsvBlockedVector {
+    public:
+
+        /**
+         * Forward iterator visiting elements block by block.
+         */
+        class iterator {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef T* pointer;
+            typedef T& reference;
+
+            iterator(std::vector<std::vector<T> >* blocks,
+                    unsigned long block, unsigned long offset)
+            : _blocks(blocks), _block(block), _offset(offset) {
+            }
+
+            T& operator*() const {
+                return (*_blocks)[_block][_offset];
+            }
+
+            T* operator->() const {
+                return &(*_blocks)[_block][_offset];
+            }
+
+            iterator& operator++() {
+                if (++_offset == (*_blocks)[_block].size()) {
+                    ++_block;
+                    _offset = 0;
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator previous = *this;
+                ++(*this);
+                return previous;
+            }
+
+            bool operator==(const iterator& other) const {
+                return _block == other._block && _offset == other._offset;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return !(*this == other);
+            }
+
+        private:
+            std::vector<std::vector<T> >* _blocks;
+            unsigned long _block;
+            unsigned long _offset;
+        };
+
+        CsvBlockedVector() : _size(0), _fullBlocksFlag(true) {
+        }
+
+        template <class InputIterator>
+        CsvBlockedVector(InputIterator first, InputIterator last)
+        : _size(0), _fullBlocksFlag(true) {
+            for (; first != last; ++first) push_back(*first);
+        }
+
+        long long size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        T& operator[](long long index) {
+            if (_fullBlocksFlag) {
+                return _blocks[index >> _blockShift][index & (_blockSize - 1)];
+            }
+            unsigned long block = findBlock(index);
+            return _blocks[block][index - _blockStarts[block]];
+        }
+
+        const T& operator[](long long index) const {
+            return const_cast<CsvBlockedVector*> (this)->operator[](index);
+        }
+
+        T& at(long long index) {
+            if (index < 0 || index >= _size) {
+                throw std::out_of_range("CsvBlockedVector index is out of range!");
+            }
+            return (*this)[index];
+        }
+
+        iterator begin() {
+            return iterator(&_blocks, 0, 0);
+        }
+
+        iterator end() {
+            return iterator(&_blocks, _blocks.size(), 0);
+        }
+
+        /**
+         * Method is used to replace content with count copies of value.
+         */
+        void assign(long long count, const T& value) {
+            clear();
+            for (long long blockStart = 0; blockStart < count; blockStart += _blockSize) {
+                _blockStarts.push_back(blockStart);
+                _blocks.emplace_back(std::min(count - blockStart, (long long) _blockSize),
+                        value);
+            }
+            _size = count;
+        }
+
+        void push_back(const T& value) {
+            if (_blocks.empty() || (long long) _blocks.back().size() >= _blockSize) {
+                _blockStarts.push_back(_size);
+                _blocks.emplace_back();
+            }
+            _blocks.back().push_back(value);
+            ++_size;
+        }
+
+        /**
+         * Method is used to insert value before element of given index.
+         *
+         * @param index - size() appends the value
+         * @param value
+         */
+        void insert(long long index, const T& value) {
+            if (index == _size) {
+                push_back(value);
+                return;
+            }
+            unsigned long block = findBlock(index);
+            std::vector<T>& values = _blocks[block];
+            values.insert(values.begin() + (index - _blockStarts[block]), value);
+            for (unsigned long next = block + 1; next < _blocks.size(); ++next) {
+                ++_blockStarts[next];
+            }
+            ++_size;
+            _fullBlocksFlag = false;
+            if ((long long) values.size() >= 2 * _blockSize) splitBlock(block);
+        }
+
+        /**
+         * Method is used to change amount of elements, memory of removed
+         * blocks is freed.
+         */
+        void resize(long long count) {
+            while (_size > count) {
+                long long blockCount = _blocks.back().size();
+                if (_size - blockCount >= count) {
+                    _blocks.pop_back();
+                    _blockStarts.pop_back();
+                    _size -= blockCount;
+                } else {
+                    _blocks.back().resize(count - _blockStarts.back());
+                    _size = count;
+                }
+            }
+            while (_size < count) push_back(T());
+        }
+
+        void clear() {
+            std::vector<std::vector<T> >().swap(_blocks);
+            std::vector<long long>().swap(_blockStarts);
+            _size = 0;
+            _fullBlocksFlag = true;
+        }
+
+        void swap(CsvBlockedVector& other) {
+            _blocks.swap(other._blocks);
+            _blockStarts.swap(other._blockStarts);
+            std::swap(_size, other._size);
+            std::swap(_fullBlocksFlag, other._fullBlocksFlag);
+        }
+
+        /**
+         * Amount of elements which fit into allocated blocks.
+         */
+        long long capacity() const {
+            long long capacity = 0;
+            for (const std::vector<T>& values : _blocks) capacity += values.capacity();
+            return capacity;
+        }
+
+        /**
+         * Method returns copy of all elements in one vector.
+         *
+         * @return elements
+         */
+        std::vector<T> toVector() const {
+            std::vector<T> values;
+            values.reserve(_size);
+            for (const std::vector<T>& block : _blocks) {
+                values.insert(values.end(), block.begin(), block.end());
+            }
+            return values;
+        }
+
+    private:
+        static const int _blockShift = 16;
+        static const long long _blockSize = 1LL << _blockShift;
+
+        std::vector<std::vector<T> > _blocks;
+        std::vector<long long> _blockStarts;
+        long long _size;
+
+        /**
+         * Flag is set when all blocks except the last one hold _blockSize
+         * elements, so block of element is computed without search.
+         */
+        bool _fullBlocksFlag;
+
+        unsigned long findBlock(long long index) const {
+            return std::upper_bound(_blockStarts.begin(), _blockStarts.end(), index)
+                    - _blockStarts.begin() - 1;
+        }
+
+        void splitBlock(unsigned long block) {
+            std::vector<T>& values = _blocks[block];
+            long long half = values.size() / 2;
+            std::vector<T> tail(values.begin() + half, values.end());
+            values.resize(half);
+            _blocks.insert(_blocks.begin() + block + 1, std::move(tail));
+            _blockStarts.insert(_blockStarts.begin() + block + 1,
+                    _blockStarts[block] + half);
+        }
+    };
+}
+
+#endif /* CSVBLOCKEDVECTOR_HPP */
@@ -0,0 +1,208 @@
+/*
+ * File:   CsvChunkReader.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvChunkReader.hpp"
+#include "CsvHandlerExceptions.hpp"
+#include <chrono>
+#include <algorithm>
+
+using namespace csvh;
+
+CsvChunkReader::CsvChunkReader(CsvDataSource* source, const std::string& prefix,
+        long long chunkSize, bool readAhead)
+: _source(source), _prefix(prefix), _chunkSize(chunkSize),
+_readAhead(readAhead), _waitTime(0) {
+    _prefixPosition = 0;
+    _hasPendingByte = false;
+    _consumerBuffer = -1;
+    _producerBuffer = 0;
+    _endOfData = false;
+    _stopFlag = false;
+    for (ChunkBuffer& buffer : _buffers) {
+        buffer.size = 0;
+        buffer.filled = false;
+        buffer.last = false;
+        buffer.capacity = 0;
+    }
+    if (_readAhead) startReadAhead();
+}
+
+CsvChunkReader::~CsvChunkReader() {
+    stopReadAhead();
+}
+
+void CsvChunkReader::fillBuffer(ChunkBuffer& buffer, long long chunkSize) {
+    bool wholeSource = chunkSize == _wholeSource;
+    long long bufferSize = _headroomSize
+            + (wholeSource ? _wholeSourceReadSize : chunkSize);
+    if ((long long) buffer.bytes.size() < bufferSize) {
+        buffer.bytes.resize(bufferSize);
+    } else if (!wholeSource && (long long) buffer.bytes.capacity()
+            > bufferSize + bufferSize / 4) {
+        // Oversized buffer is released, so that smaller chunk size really
+        // lowers memory usage.
+        std::vector<char>(bufferSize).swap(buffer.bytes);
+    }
+    buffer.capacity = buffer.bytes.capacity();
+
+    buffer.size = 0;
+    buffer.last = false;
+    if (_hasPendingByte) {
+        buffer.bytes[_headroomSize] = _pendingByte;
+        buffer.size = 1;
+        _hasPendingByte = false;
+    }
+
+    while (!buffer.last) {
+        long long capacity = buffer.bytes.size() - _headroomSize;
+        if (buffer.size == capacity) {
+            if (!wholeSource) break;
+            buffer.bytes.resize(_headroomSize + capacity * 2);
+            buffer.capacity = buffer.bytes.capacity();
+            capacity *= 2;
+        }
+        long long bytesRead = readData(&buffer.bytes[_headroomSize + buffer.size],
+                capacity - buffer.size);
+        buffer.size += bytesRead;
+        buffer.last = bytesRead == 0;
+    }
+
+    if (!buffer.last) {
+        _hasPendingByte = readData(&_pendingByte, 1) == 1;
+        buffer.last = !_hasPendingByte;
+    }
+}
+
+long long CsvChunkReader::readData(char* data, long long size) {
+    long long bytesRead = 0;
+    if (_prefixPosition < _prefix.size()) {
+        bytesRead = std::min(size, (long long) (_prefix.size() - _prefixPosition));
+        _prefix.copy(data, bytesRead, _prefixPosition);
+        _prefixPosition += bytesRead;
+    }
+    while (bytesRead < size) {
+        long long sourceBytes = _source->read(data + bytesRead, size - bytesRead);
+        if (sourceBytes == 0) break;
+        bytesRead += sourceBytes;
+    }
+    return bytesRead;
+}
+
+CsvChunk CsvChunkReader::nextChunk() {
+    std::chrono::steady_clock::time_point waitStart =
+            std::chrono::steady_clock::now();
+
+    if (_consumerBuffer != -1 && _buffers[_consumerBuffer].last) {
+        ChunkBuffer& buffer = _buffers[_consumerBuffer];
+        CsvChunk emptyChunk = {&buffer.bytes[_headroomSize], 0, _headroomSize, true};
+        return emptyChunk;
+    }
+
+    if (!_readAhead) {
+        _consumerBuffer = 0;
+        fillBuffer(_buffers[0], _chunkSize);
+    } else {
+        std::unique_lock<std::mutex> lock(_mutex);
+        int nextBuffer = 0;
+        if (_consumerBuffer != -1) {
+            _buffers[_consumerBuffer].filled = false;
+            nextBuffer = 1 - _consumerBuffer;
+            _bufferReleased.notify_one();
+        }
+        _bufferFilled.wait(lock, [this, nextBuffer]() {
+            return _buffers[nextBuffer].filled || _readError;
+        });
+        if (_readError) {
+            std::rethrow_exception(_readError);
+        }
+        _consumerBuffer = nextBuffer;
+    }
+
+    _waitTime += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - waitStart).count();
+
+    ChunkBuffer& buffer = _buffers[_consumerBuffer];
+    CsvChunk chunk = {&buffer.bytes[_headroomSize], buffer.size,
+        _headroomSize, buffer.last};
+    return chunk;
+}
+
+void CsvChunkReader::rewind() {
+    stopReadAhead();
+    if (!_source->rewind()) {
+        throw UnableToRewindSourceException();
+    }
+    // Source starts from the beginning, prefix must not be replayed.
+    _prefixPosition = _prefix.size();
+    _hasPendingByte = false;
+    _consumerBuffer = -1;
+    _producerBuffer = 0;
+    _endOfData = false;
+    _stopFlag = false;
+    _readError = std::exception_ptr();
+    for (ChunkBuffer& buffer : _buffers) {
+        buffer.filled = false;
+        buffer.last = false;
+    }
+    if (_readAhead) startReadAhead();
+}
+
+void CsvChunkReader::setChunkSize(long long chunkSize) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _chunkSize = chunkSize;
+}
+
+long long CsvChunkReader::getBuffersCapacity() const {
+    // Buffers are resized by the read-ahead thread without the lock,
+    // so only their published capacity is read here.
+    long long capacity = 0;
+    for (const ChunkBuffer& buffer : _buffers) {
+        capacity += buffer.capacity;
+    }
+    return capacity;
+}
+
+void CsvChunkReader::readAheadLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_endOfData) {
+        ChunkBuffer& buffer = _buffers[_producerBuffer];
+        _bufferReleased.wait(lock, [this, &buffer]() {
+            return _stopFlag || !buffer.filled;
+        });
+        if (_stopFlag) return;
+
+        long long chunkSize = _chunkSize;
+        lock.unlock();
+        try {
+            fillBuffer(buffer, chunkSize);
+        } catch (...) {
+            lock.lock();
+            _readError = std::current_exception();
+            _bufferFilled.notify_one();
+            return;
+        }
+        lock.lock();
+
+        buffer.filled = true;
+        _endOfData = buffer.last;
+        _producerBuffer = 1 - _producerBuffer;
+        _bufferFilled.notify_one();
+    }
+}
+
+void CsvChunkReader::startReadAhead() {
+    _readerThread = std::thread(&CsvChunkReader::readAheadLoop, this);
+}
+
+void CsvChunkReader::stopReadAhead() {
+    if (_readerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopFlag = true;
+        }
+        _bufferReleased.notify_one();
+        _readerThread.join();
+    }
+}
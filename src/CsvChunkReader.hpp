@@ -0,0 +1,171 @@
+/*
+ * File:   CsvChunkReader.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVCHUNKREADER_HPP
+#define CSVCHUNKREADER_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include "CsvDataSource.hpp"
+
+namespace csvh {
+
+    /**
+     * Chunk of the input file returned by CsvChunkReader.
+     * Up to headroom bytes in front of data can be written by the caller,
+     * e.g. to prepend an unfinished entry from the previous chunk.
+     */
+    struct CsvChunk {
+        char* data;
+        long long size;
+        long long headroom;
+        bool last;
+    };
+
+    /**
+     * Class is used to read input data chunk by chunk.
+     * Source is read sequentially into reused buffers, without seeks.
+     * In read-ahead mode the next chunk is read by a background thread
+     * while the current one is being parsed.
+     */
+    class CsvChunkReader {
+    public:
+
+        /**
+         * Chunk size used to read the whole source as a single chunk.
+         */
+        static const long long _wholeSource = -1;
+
+        /**
+         * @param source - data source, not owned by the reader
+         * @param prefix - bytes already consumed from the source which
+         *        are returned before the rest of the source
+         * @param chunkSize - amount of bytes read per chunk
+         * @param readAhead - read next chunk in a background thread
+         */
+        CsvChunkReader(CsvDataSource* source, const std::string& prefix,
+                long long chunkSize, bool readAhead);
+
+        ~CsvChunkReader();
+
+        /**
+         * Method is used to fetch next chunk of the file.
+         * Chunk returned by the previous call is released and can not
+         * be used anymore.
+         *
+         * @return next chunk
+         */
+        CsvChunk nextChunk();
+
+        /**
+         * Method is used to start reading again from the beginning of source.
+         * Throws UnableToRewindSourceException if source is not seekable.
+         */
+        void rewind();
+
+        /**
+         * Method is used to change amount of bytes read per chunk.
+         * In read-ahead mode chunk which is already being read keeps
+         * its size, new size is used for the following ones.
+         *
+         * @param chunkSize
+         */
+        void setChunkSize(long long chunkSize);
+
+        /**
+         * Method returns amount of memory allocated for chunk buffers.
+         *
+         * @return size in bytes
+         */
+        long long getBuffersCapacity() const;
+
+        /**
+         * Method returns how long the consumer was blocked in nextChunk
+         * waiting for data.
+         *
+         * @return wait time in microseconds
+         */
+        long long getWaitTime() const {
+            return _waitTime;
+        }
+
+    private:
+
+        struct ChunkBuffer {
+            std::vector<char> bytes;
+            long long size;
+            bool filled;
+            bool last;
+
+            /**
+             * Capacity of bytes published by the thread filling the
+             * buffer, read by getBuffersCapacity without locking.
+             */
+            std::atomic<long long> capacity;
+        };
+
+        static const long long _headroomSize = 1024 * 64;
+        static const long long _wholeSourceReadSize = 1024 * 1024;
+
+        CsvDataSource* _source;
+        std::string _prefix;
+        unsigned long _prefixPosition;
+        char _pendingByte;
+        bool _hasPendingByte;
+        long long _chunkSize;
+        bool _readAhead;
+        long long _waitTime;
+
+        ChunkBuffer _buffers[2];
+        int _consumerBuffer;
+        int _producerBuffer;
+        bool _endOfData;
+        bool _stopFlag;
+
+        std::thread _readerThread;
+        std::mutex _mutex;
+        std::condition_variable _bufferFilled;
+        std::condition_variable _bufferReleased;
+        std::exception_ptr _readError;
+
+        /**
+         * Method is used to read next chunk from source into buffer.
+         * Buffer is reallocated if its size does not fit chunkSize.
+         * One byte is read ahead to find out if chunk is the last one.
+         *
+         * @param buffer
+         * @param chunkSize
+         */
+        void fillBuffer(ChunkBuffer& buffer, long long chunkSize);
+
+        /**
+         * Method is used to read from prefix and then from source
+         * until size bytes are read or end of data is reached.
+         *
+         * @param data
+         * @param size
+         * @return amount of bytes read
+         */
+        long long readData(char* data, long long size);
+
+        /**
+         * Body of the background thread used in read-ahead mode.
+         */
+        void readAheadLoop();
+
+        void startReadAhead();
+        void stopReadAhead();
+
+        CsvChunkReader(const CsvChunkReader&);
+        CsvChunkReader& operator=(const CsvChunkReader&);
+    };
+}
+
+#endif /* CSVCHUNKREADER_HPP */
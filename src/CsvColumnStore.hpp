@@ -0,0 +1,945 @@
+/*
+ * File:   CsvColumnStore.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVCOLUMNSTORE_HPP
+#define CSVCOLUMNSTORE_HPP
+
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <limits>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "CsvStringSlice.hpp"
+#include "CsvRowTombstones.hpp"
+
+namespace csvh {
+
+    /**
+     * Tag of date columns. Dates are stored as std::time_t, which can be
+     * the same type as long long, so date arrays are selected with this
+     * tag instead of the value type.
+     */
+    struct CsvDate {
+    };
+
+    /**
+     * Type of values stored for column of type T.
+     */
+    template <class T>
+    struct CsvStoredValue {
+        typedef T type;
+    };
+
+    template <>
+    struct CsvStoredValue<CsvDate> {
+        typedef std::time_t type;
+    };
+
+    /**
+     * Read-only view of contiguous values of a column.
+     * Valid until the column is converted, cleared or next chunk is loaded.
+     */
+    template <class T>
+    class CsvColumnSpan {
+    public:
+
+        CsvColumnSpan() : _data(nullptr), _size(0) {
+        }
+
+        CsvColumnSpan(const T* data, long long size) : _data(data), _size(size) {
+        }
+
+        const T* data() const {
+            return _data;
+        }
+
+        const T* begin() const {
+            return _data;
+        }
+
+        const T* end() const {
+            return _data + _size;
+        }
+
+        long long size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        const T& operator[](long long index) const {
+            return _data[index];
+        }
+
+    private:
+        const T* _data;
+        long long _size;
+    };
+
+    /**
+     * Values of a single loaded column kept in row groups of contiguous
+     * memory. Numbers and dates are stored in a typed array, strings in one
+     * byte buffer with offsets of consecutive fields. String column with few
+     * distinct values can be dictionary encoded, then the dictionary holds
+     * every distinct value once and rows hold codes of the values.
+     * Integer column can be narrowed to the smallest of int8_t, int16_t,
+     * int and long long which holds all its values.
+     * Fields which could not be converted are marked in a validity bitmap.
+     * Column is loaded into one row group. Inserting a row splits its group
+     * into groups of 64K rows, so later inserts shift one group only,
+     * a group growing twice over the limit is split again.
+     * Methods returning arrays (values, getSpan, getCodes, getOffsets and
+     * getBytes) require one row group, see mergeRowGroups.
+     * Different rows can be written by different threads, except
+     * for notSet and allocateStrings.
+     */
+    class CsvColumnStore {
+    public:
+
+        CsvColumnStore() : _rows(0), _groups(1), _groupStarts(1, 0),
+        _dictionaryFlag(false), _integerWidth(0) {
+        }
+
+        /**
+         * Method is used to allocate column of int, long long, double
+         * or date (CsvDate) values. All fields are marked as set.
+         *
+         * @param amountOfRows
+         */
+        template <class T>
+        void assign(long long amountOfRows) {
+            reset();
+            _rows = amountOfRows;
+            _groups[0].rows = amountOfRows;
+            valueVector(_groups[0], (T*) nullptr).resize(amountOfRows);
+            _groups[0].validity.assign((amountOfRows + 63) / 64, ~0ULL);
+            _integerWidth = integerWidth((T*) nullptr);
+        }
+
+        template <class T>
+        typename CsvStoredValue<T>::type* values() {
+            return valueVector(_groups[0], (T*) nullptr).data();
+        }
+
+        template <class T>
+        const typename CsvStoredValue<T>::type* values() const {
+            return const_cast<CsvColumnStore*> (this)->values<T>();
+        }
+
+        /**
+         * Method returns value of the row in any row group.
+         *
+         * @param row
+         * @return value
+         */
+        template <class T>
+        typename CsvStoredValue<T>::type& value(long long row) {
+            long long groupRow;
+            RowGroup& group = findGroup(row, groupRow);
+            return valueVector(group, (T*) nullptr)[groupRow];
+        }
+
+        template <class T>
+        const typename CsvStoredValue<T>::type& value(long long row) const {
+            return const_cast<CsvColumnStore*> (this)->value<T>(row);
+        }
+
+        template <class T>
+        CsvColumnSpan<typename CsvStoredValue<T>::type> getSpan() const {
+            return CsvColumnSpan<typename CsvStoredValue<T>::type>(
+                    values<T>(), _rows);
+        }
+
+        /**
+         * Method returns bytes used by single value of integer column,
+         * 0 for other columns. Values are read with values<T>() where
+         * T is int8_t, int16_t, int or long long of that size.
+         *
+         * @return integer width
+         */
+        int getIntegerWidth() const {
+            return _integerWidth;
+        }
+
+        /**
+         * Method returns value of integer column of any width.
+         *
+         * @param row
+         * @return value
+         */
+        long long getInteger(long long row) const {
+            long long groupRow;
+            const RowGroup& group = findGroup(row, groupRow);
+            return getInteger(group, groupRow);
+        }
+
+        /**
+         * Method is used to store integer column with the smallest width
+         * holding all its values.
+         */
+        void narrowIntegers() {
+            if (_integerWidth == 0 || _rows == 0) return;
+            long long minValue = getInteger(0);
+            long long maxValue = minValue;
+            for (const RowGroup& group : _groups) {
+                for (long long row = 0; row < group.rows; ++row) {
+                    long long value = getInteger(group, row);
+                    if (value < minValue) minValue = value;
+                    if (value > maxValue) maxValue = value;
+                }
+            }
+            if (fitsIn<int8_t>(minValue, maxValue)) {
+                storeIntegers<int8_t>();
+            } else if (fitsIn<int16_t>(minValue, maxValue)) {
+                storeIntegers<int16_t>();
+            } else if (fitsIn<int>(minValue, maxValue)) {
+                storeIntegers<int>();
+            }
+        }
+
+        /**
+         * Method is used to store integer column with given type,
+         * e.g. before it is returned as a span of that type.
+         */
+        template <class T>
+        void widen() {
+            if (_integerWidth != 0 && _integerWidth != (int) sizeof (T)) {
+                storeIntegers<T>();
+            }
+        }
+
+        /**
+         * Method is used to allocate column of strings. Lengths of all
+         * fields have to be set before allocateStrings is called,
+         * then text is copied with setString.
+         *
+         * @param amountOfRows
+         */
+        void assignStrings(long long amountOfRows) {
+            reset();
+            _rows = amountOfRows;
+            _groups[0].rows = amountOfRows;
+            _groups[0].offsets.assign(amountOfRows + 1, 0);
+            _groups[0].validity.assign((amountOfRows + 63) / 64, ~0ULL);
+        }
+
+        void setStringLength(long long row, long long length) {
+            _groups[0].offsets[row + 1] = length;
+        }
+
+        void allocateStrings() {
+            std::vector<long long>& offsets = _groups[0].offsets;
+            for (long long row = 0; row < _rows; ++row) {
+                offsets[row + 1] += offsets[row];
+            }
+            _groups[0].bytes.resize(offsets.back());
+        }
+
+        void setString(long long row, const char* text) {
+            const std::vector<long long>& offsets = _groups[0].offsets;
+            long long length = offsets[row + 1] - offsets[row];
+            if (length > 0) std::memcpy(&_groups[0].bytes[offsets[row]], text, length);
+        }
+
+        CsvStringSlice getString(long long row) const {
+            long long groupRow;
+            const RowGroup& group = findGroup(row, groupRow);
+            return getString(group, groupRow);
+        }
+
+        /**
+         * Method is used to dictionary encode string column. Encoding is
+         * abandoned when column has more distinct values than given limit.
+         *
+         * @param maxDictionarySize
+         * @return true when column was encoded
+         */
+        bool encodeDictionary(long long maxDictionarySize) {
+            if (_dictionaryFlag) return true;
+            std::unordered_map<CsvStringSlice, uint32_t, CsvStringSliceHash> codes;
+            std::vector<std::vector<uint32_t> > groupCodes(_groups.size());
+            std::vector<long long> offsets(1, 0);
+            std::vector<char> bytes;
+            for (unsigned long groupId = 0; groupId < _groups.size(); ++groupId) {
+                const RowGroup& group = _groups[groupId];
+                groupCodes[groupId].resize(group.rows);
+                for (long long row = 0; row < group.rows; ++row) {
+                    CsvStringSlice value = getString(group, row);
+                    auto code = codes.find(value);
+                    if (code == codes.end()) {
+                        if ((long long) codes.size() >= maxDictionarySize) return false;
+                        code = codes.emplace(value, codes.size()).first;
+                        bytes.insert(bytes.end(), value.begin(), value.end());
+                        offsets.push_back(bytes.size());
+                    }
+                    groupCodes[groupId][row] = code->second;
+                }
+            }
+            // Dictionary keys reference old buffers, so they are freed last.
+            for (unsigned long groupId = 0; groupId < _groups.size(); ++groupId) {
+                RowGroup& group = _groups[groupId];
+                group.codes.swap(groupCodes[groupId]);
+                std::vector<long long>().swap(group.offsets);
+                std::vector<char>().swap(group.bytes);
+            }
+            _dictionaryOffsets.swap(offsets);
+            _dictionaryBytes.swap(bytes);
+            _dictionaryFlag = true;
+            return true;
+        }
+
+        bool isDictionaryEncoded() const {
+            return _dictionaryFlag;
+        }
+
+        /**
+         * Codes of rows of dictionary encoded column.
+         */
+        const std::vector<uint32_t>& getCodes() const {
+            return _groups[0].codes;
+        }
+
+        /**
+         * Method returns code of the row in any row group.
+         *
+         * @param row
+         * @return code
+         */
+        uint32_t getCode(long long row) const {
+            long long groupRow;
+            const RowGroup& group = findGroup(row, groupRow);
+            return group.codes[groupRow];
+        }
+
+        long long getDictionarySize() const {
+            return _dictionaryFlag ? _dictionaryOffsets.size() - 1 : 0;
+        }
+
+        CsvStringSlice getDictionaryValue(long long code) const {
+            return CsvStringSlice(_dictionaryBytes.data() + _dictionaryOffsets[code],
+                    _dictionaryOffsets[code + 1] - _dictionaryOffsets[code]);
+        }
+
+        /**
+         * Method is used to change values of dictionary encoded column.
+         * Codes which get equal values are merged, so that every value
+         * is kept once, and their rows are remapped.
+         *
+         * @param values - new value for every code
+         */
+        void setDictionaryValues(const std::vector<std::string>& values) {
+            std::unordered_map<std::string, uint32_t> codes;
+            std::vector<uint32_t> newCodes(values.size());
+            bool merged = false;
+            _dictionaryOffsets.assign(1, 0);
+            _dictionaryBytes.clear();
+            for (unsigned long code = 0; code < values.size(); ++code) {
+                auto inserted = codes.emplace(values[code], codes.size());
+                newCodes[code] = inserted.first->second;
+                if (!inserted.second) {
+                    merged = true;
+                    continue;
+                }
+                _dictionaryBytes.insert(_dictionaryBytes.end(),
+                        values[code].begin(), values[code].end());
+                _dictionaryOffsets.push_back(_dictionaryBytes.size());
+            }
+            if (merged) {
+                for (RowGroup& group : _groups) {
+                    for (uint32_t& code : group.codes) code = newCodes[code];
+                }
+            }
+        }
+
+        /**
+         * Offsets of string fields, field i occupies bytes
+         * [offsets[i], offsets[i + 1]). For dictionary encoded column
+         * i is a code.
+         */
+        const std::vector<long long>& getOffsets() const {
+            return _dictionaryFlag ? _dictionaryOffsets : _groups[0].offsets;
+        }
+
+        const char* getBytes() const {
+            return _dictionaryFlag ? _dictionaryBytes.data() : _groups[0].bytes.data();
+        }
+
+        bool isSet(long long row) const {
+            long long groupRow;
+            const RowGroup& group = findGroup(row, groupRow);
+            return (group.validity[groupRow / 64] >> (groupRow % 64)) & 1;
+        }
+
+        void notSet(long long row) {
+            long long groupRow;
+            RowGroup& group = findGroup(row, groupRow);
+            group.validity[groupRow / 64] &= ~(1ULL << (groupRow % 64));
+        }
+
+        /**
+         * Method is used to mark all fields as not set, e.g. of a new
+         * column.
+         */
+        void notSetAll() {
+            for (RowGroup& group : _groups) {
+                group.validity.assign(group.validity.size(), 0);
+            }
+        }
+
+        /**
+         * Method is used to insert row before given one, value is copied
+         * from row of other column of the same type. Integer column is
+         * widened when the value does not fit its width, dictionary gets
+         * the value when it does not hold it yet. Values of one row group
+         * are shifted.
+         *
+         * @param row - position of the new row, up to size()
+         * @param source - column holding the value
+         * @param sourceRow
+         */
+        void insertRow(long long row, const CsvColumnStore& source,
+                long long sourceRow) {
+            if (source._integerWidth != 0 && _integerWidth != 0
+                    && !fitsWidth(source.getInteger(sourceRow))) {
+                storeIntegers<long long>();
+            }
+            unsigned long groupId = findInsertionGroup(row);
+            RowGroup& group = _groups[groupId];
+            long long groupRow = row - _groupStarts[groupId];
+            if (source._dictionaryFlag || !source._groups[0].offsets.empty()) {
+                insertString(group, groupRow, source.getString(sourceRow));
+            } else if (source._integerWidth != 0) {
+                long long value = source.getInteger(sourceRow);
+                switch (_integerWidth) {
+                    case 1: insertValue(group.int8s, groupRow, (int8_t) value);
+                        break;
+                    case 2: insertValue(group.int16s, groupRow, (int16_t) value);
+                        break;
+                    case 4: insertValue(group.ints, groupRow, (int) value);
+                        break;
+                    default: insertValue(group.int64s, groupRow, value);
+                        break;
+                }
+            } else if (!source._groups[0].doubles.empty()) {
+                insertValue(group.doubles, groupRow, source.value<double>(sourceRow));
+            } else {
+                insertValue(group.dates, groupRow, source.value<CsvDate>(sourceRow));
+            }
+            insertValidity(group, groupRow, source.isSet(sourceRow));
+            ++group.rows;
+            ++_rows;
+            for (unsigned long next = groupId + 1; next < _groups.size(); ++next) {
+                ++_groupStarts[next];
+            }
+            if (group.rows >= 2 * _groupRows) splitGroup(groupId);
+        }
+
+        /**
+         * Method is used to keep all rows in one row group, so that they
+         * can be returned as arrays. Groups are split again by next insert.
+         */
+        void mergeRowGroups() {
+            if (_groups.size() == 1) return;
+            RowGroup merged;
+            merged.rows = _rows;
+            merged.validity.assign((_rows + 63) / 64, ~0ULL);
+            if (!_groups[0].offsets.empty()) merged.offsets.assign(1, 0);
+            for (unsigned long groupId = 0; groupId < _groups.size(); ++groupId) {
+                RowGroup& group = _groups[groupId];
+                appendValues(merged.int8s, group.int8s);
+                appendValues(merged.int16s, group.int16s);
+                appendValues(merged.ints, group.ints);
+                appendValues(merged.int64s, group.int64s);
+                appendValues(merged.doubles, group.doubles);
+                appendValues(merged.dates, group.dates);
+                appendValues(merged.codes, group.codes);
+                if (!group.offsets.empty()) {
+                    long long base = merged.bytes.size();
+                    for (long long row = 1; row <= group.rows; ++row) {
+                        merged.offsets.push_back(base + group.offsets[row]);
+                    }
+                    appendValues(merged.bytes, group.bytes);
+                }
+                for (long long row = 0; row < group.rows; ++row) {
+                    if ((group.validity[row / 64] >> (row % 64)) & 1) continue;
+                    long long mergedRow = _groupStarts[groupId] + row;
+                    merged.validity[mergedRow / 64] &= ~(1ULL << (mergedRow % 64));
+                }
+            }
+            _groups.assign(1, RowGroup());
+            std::swap(_groups[0], merged);
+            _groupStarts.assign(1, 0);
+        }
+
+        /**
+         * Method returns amount of row groups the column is kept in.
+         *
+         * @return amount of row groups
+         */
+        long long getAmountOfRowGroups() const {
+            return _groups.size();
+        }
+
+        long long size() const {
+            return _rows;
+        }
+
+        /**
+         * Method is used to drop removed rows, other rows are moved
+         * to the front of their row groups in one pass. Memory is kept.
+         *
+         * @param removedRows - bitmap of the same amount of rows
+         */
+        void removeRows(const CsvRowTombstones& removedRows) {
+            std::vector<RowGroup> groups;
+            std::vector<long long> groupStarts;
+            long long kept = 0;
+            for (unsigned long groupId = 0; groupId < _groups.size(); ++groupId) {
+                RowGroup& group = _groups[groupId];
+                long long start = _groupStarts[groupId];
+                long long keptRows = removeGroupRows(group, start, removedRows);
+                // Empty groups are dropped, the last one is kept
+                // when all rows are removed.
+                if (keptRows == 0 && (kept > 0 || groupId + 1 < _groups.size())) {
+                    continue;
+                }
+                groupStarts.push_back(kept);
+                groups.push_back(std::move(group));
+                kept += keptRows;
+            }
+            _groups.swap(groups);
+            _groupStarts.swap(groupStarts);
+            _rows = kept;
+        }
+
+        /**
+         * Method is used to free column memory.
+         */
+        void clear() {
+            _rows = 0;
+            _dictionaryFlag = false;
+            _integerWidth = 0;
+            std::vector<RowGroup>(1).swap(_groups);
+            std::vector<long long>(1, 0).swap(_groupStarts);
+            std::vector<long long>().swap(_dictionaryOffsets);
+            std::vector<char>().swap(_dictionaryBytes);
+        }
+
+        /**
+         * Method returns bytes allocated by the column.
+         *
+         * @return memory usage
+         */
+        long long getMemoryUsage() const {
+            // The first group is a part of the store.
+            long long usage = (_groups.capacity() - 1) * sizeof (RowGroup)
+                    + (_groupStarts.capacity() - 1) * sizeof (long long)
+                    + _dictionaryOffsets.capacity() * sizeof (long long)
+                    + _dictionaryBytes.capacity();
+            for (const RowGroup& group : _groups) {
+                usage += group.int8s.capacity() * sizeof (int8_t)
+                        + group.int16s.capacity() * sizeof (int16_t)
+                        + group.ints.capacity() * sizeof (int)
+                        + group.int64s.capacity() * sizeof (long long)
+                        + group.doubles.capacity() * sizeof (double)
+                        + group.dates.capacity() * sizeof (std::time_t)
+                        + group.offsets.capacity() * sizeof (long long)
+                        + group.bytes.capacity()
+                        + group.validity.capacity() * sizeof (uint64_t)
+                        + group.codes.capacity() * sizeof (uint32_t);
+            }
+            return usage;
+        }
+
+        /**
+         * Method returns bytes allocated for text of string fields,
+         * part of getMemoryUsage.
+         *
+         * @return memory usage
+         */
+        long long getStringMemoryUsage() const {
+            long long usage = _dictionaryBytes.capacity();
+            for (const RowGroup& group : _groups) usage += group.bytes.capacity();
+            return usage;
+        }
+
+    private:
+
+        /**
+         * Consecutive rows of the column. Array not used by the column
+         * is empty, strings of dictionary encoded column are kept once
+         * for all groups.
+         */
+        struct RowGroup {
+
+            RowGroup() : rows(0) {
+            }
+
+            long long rows;
+            std::vector<int8_t> int8s;
+            std::vector<int16_t> int16s;
+            std::vector<int> ints;
+            std::vector<long long> int64s;
+            std::vector<double> doubles;
+            std::vector<std::time_t> dates;
+            std::vector<long long> offsets;
+            std::vector<char> bytes;
+            std::vector<uint64_t> validity;
+            std::vector<uint32_t> codes;
+        };
+
+        static const long long _groupRows = 1LL << 16;
+
+        long long _rows;
+        std::vector<RowGroup> _groups;
+
+        /**
+         * Index of the first row of every group.
+         */
+        std::vector<long long> _groupStarts;
+        std::vector<long long> _dictionaryOffsets;
+        std::vector<char> _dictionaryBytes;
+        bool _dictionaryFlag;
+        int _integerWidth;
+
+        /**
+         * Method is used to remove values, memory allocated by the first
+         * row group is kept.
+         */
+        void reset() {
+            _rows = 0;
+            _dictionaryFlag = false;
+            _integerWidth = 0;
+            _groups.resize(1);
+            _groupStarts.assign(1, 0);
+            RowGroup& group = _groups[0];
+            group.rows = 0;
+            group.int8s.clear();
+            group.int16s.clear();
+            group.ints.clear();
+            group.int64s.clear();
+            group.doubles.clear();
+            group.dates.clear();
+            group.offsets.clear();
+            group.bytes.clear();
+            group.validity.clear();
+            group.codes.clear();
+            _dictionaryOffsets.clear();
+            _dictionaryBytes.clear();
+        }
+
+        const RowGroup& findGroup(long long row, long long& groupRow) const {
+            if (_groups.size() == 1) {
+                groupRow = row;
+                return _groups[0];
+            }
+            unsigned long groupId = std::upper_bound(_groupStarts.begin(),
+                    _groupStarts.end(), row) - _groupStarts.begin() - 1;
+            groupRow = row - _groupStarts[groupId];
+            return _groups[groupId];
+        }
+
+        RowGroup& findGroup(long long row, long long& groupRow) {
+            return const_cast<RowGroup&> (
+                    static_cast<const CsvColumnStore*> (this)->findGroup(row, groupRow));
+        }
+
+        /**
+         * Method returns group into which row is inserted, the last one
+         * for row appended. Group of loaded column is split first.
+         */
+        unsigned long findInsertionGroup(long long row) {
+            unsigned long groupId = std::upper_bound(_groupStarts.begin(),
+                    _groupStarts.end(), row) - _groupStarts.begin() - 1;
+            if (row == _rows) groupId = _groups.size() - 1;
+            if (_groups[groupId].rows < 2 * _groupRows) return groupId;
+            splitGroup(groupId);
+            return findInsertionGroup(row);
+        }
+
+        /**
+         * Method is used to cut group into groups of _groupRows rows.
+         * Groups start at multiples of 64 rows of the old one, so bitmap
+         * words are copied whole.
+         */
+        void splitGroup(unsigned long groupId) {
+            RowGroup& group = _groups[groupId];
+            long long start = _groupStarts[groupId];
+            std::vector<RowGroup> parts((group.rows + _groupRows - 1) / _groupRows);
+            for (unsigned long partId = 0; partId < parts.size(); ++partId) {
+                RowGroup& part = parts[partId];
+                long long begin = partId * _groupRows;
+                long long end = std::min(begin + _groupRows, group.rows);
+                part.rows = end - begin;
+                copyValues(part.int8s, group.int8s, begin, end);
+                copyValues(part.int16s, group.int16s, begin, end);
+                copyValues(part.ints, group.ints, begin, end);
+                copyValues(part.int64s, group.int64s, begin, end);
+                copyValues(part.doubles, group.doubles, begin, end);
+                copyValues(part.dates, group.dates, begin, end);
+                copyValues(part.codes, group.codes, begin, end);
+                copyValues(part.validity, group.validity, begin / 64, (end + 63) / 64);
+                if (!group.offsets.empty()) {
+                    long long base = group.offsets[begin];
+                    part.offsets.reserve(part.rows + 1);
+                    for (long long row = begin; row <= end; ++row) {
+                        part.offsets.push_back(group.offsets[row] - base);
+                    }
+                    part.bytes.assign(group.bytes.begin() + base,
+                            group.bytes.begin() + group.offsets[end]);
+                }
+            }
+            std::vector<long long> partStarts;
+            for (unsigned long partId = 1; partId < parts.size(); ++partId) {
+                partStarts.push_back(start + partId * _groupRows);
+            }
+            _groups[groupId] = std::move(parts[0]);
+            _groups.insert(_groups.begin() + groupId + 1,
+                    std::make_move_iterator(parts.begin() + 1),
+                    std::make_move_iterator(parts.end()));
+            _groupStarts.insert(_groupStarts.begin() + groupId + 1,
+                    partStarts.begin(), partStarts.end());
+        }
+
+        long long getInteger(const RowGroup& group, long long row) const {
+            switch (_integerWidth) {
+                case 1: return group.int8s[row];
+                case 2: return group.int16s[row];
+                case 4: return group.ints[row];
+                default: return group.int64s[row];
+            }
+        }
+
+        CsvStringSlice getString(const RowGroup& group, long long row) const {
+            if (_dictionaryFlag) return getDictionaryValue(group.codes[row]);
+            return CsvStringSlice(group.bytes.data() + group.offsets[row],
+                    group.offsets[row + 1] - group.offsets[row]);
+        }
+
+        bool fitsWidth(long long value) const {
+            switch (_integerWidth) {
+                case 1: return fitsIn<int8_t>(value, value);
+                case 2: return fitsIn<int16_t>(value, value);
+                case 4: return fitsIn<int>(value, value);
+                default: return true;
+            }
+        }
+
+        /**
+         * Method is used to insert bit of the row, bits of next rows
+         * of the group are shifted by whole words.
+         */
+        static void insertValidity(RowGroup& group, long long row, bool set) {
+            std::vector<uint64_t>& words = group.validity;
+            words.resize((group.rows + 64) / 64, ~0ULL);
+            long long word = row / 64;
+            for (long long next = words.size() - 1; next > word; --next) {
+                words[next] = (words[next] << 1) | (words[next - 1] >> 63);
+            }
+            uint64_t lowerBits = (1ULL << (row % 64)) - 1;
+            uint64_t bits = words[word];
+            words[word] = (bits & lowerBits) | ((bits & ~lowerBits) << 1)
+                    | ((uint64_t) set << (row % 64));
+        }
+
+        void insertString(RowGroup& group, long long row, const CsvStringSlice& value) {
+            if (_dictionaryFlag) {
+                long long code = 0;
+                long long dictionarySize = getDictionarySize();
+                while (code < dictionarySize
+                        && !(getDictionaryValue(code) == value)) {
+                    ++code;
+                }
+                if (code == dictionarySize) {
+                    _dictionaryBytes.insert(_dictionaryBytes.end(),
+                            value.begin(), value.end());
+                    _dictionaryOffsets.push_back(_dictionaryBytes.size());
+                }
+                insertValue(group.codes, row, (uint32_t) code);
+                return;
+            }
+            long long begin = group.offsets[row];
+            group.bytes.insert(group.bytes.begin() + begin, value.begin(), value.end());
+            group.offsets.insert(group.offsets.begin() + row, begin);
+            for (long long next = row + 1; next < (long long) group.offsets.size(); ++next) {
+                group.offsets[next] += value.size();
+            }
+        }
+
+        template <class T>
+        static void insertValue(std::vector<T>& values, long long row, T value) {
+            values.insert(values.begin() + row, value);
+        }
+
+        template <class T>
+        static void appendValues(std::vector<T>& target, std::vector<T>& values) {
+            target.insert(target.end(), values.begin(), values.end());
+            std::vector<T>().swap(values);
+        }
+
+        /**
+         * Method is used to copy values [begin, end) of array used
+         * by the column.
+         */
+        template <class T>
+        static void copyValues(std::vector<T>& target,
+                const std::vector<T>& values, long long begin, long long end) {
+            if (values.empty()) return;
+            target.assign(values.begin() + begin, values.begin() + end);
+        }
+
+        /**
+         * Method is used to drop removed rows of the group.
+         *
+         * @param group
+         * @param start - index of first row of the group
+         * @param removedRows
+         * @return amount of rows left
+         */
+        long long removeGroupRows(RowGroup& group, long long start,
+                const CsvRowTombstones& removedRows) {
+            long long kept = 0;
+            for (long long row = 0; row < group.rows; ++row) {
+                if (!removedRows.isRemoved(start + row)) ++kept;
+            }
+            std::vector<uint64_t> validity((kept + 63) / 64, ~0ULL);
+            for (long long row = 0, keptRow = 0; row < group.rows; ++row) {
+                if (removedRows.isRemoved(start + row)) continue;
+                if (!((group.validity[row / 64] >> (row % 64)) & 1)) {
+                    validity[keptRow / 64] &= ~(1ULL << (keptRow % 64));
+                }
+                ++keptRow;
+            }
+            group.validity.swap(validity);
+
+            removeValues(group.int8s, group.rows, start, removedRows);
+            removeValues(group.int16s, group.rows, start, removedRows);
+            removeValues(group.ints, group.rows, start, removedRows);
+            removeValues(group.int64s, group.rows, start, removedRows);
+            removeValues(group.doubles, group.rows, start, removedRows);
+            removeValues(group.dates, group.rows, start, removedRows);
+            removeValues(group.codes, group.rows, start, removedRows);
+            if (!group.offsets.empty()) {
+                long long keptRow = 0;
+                long long keptBytes = 0;
+                for (long long row = 0; row < group.rows; ++row) {
+                    if (removedRows.isRemoved(start + row)) continue;
+                    // Offsets and bytes are only moved to the front,
+                    // so values of next rows are not overwritten.
+                    long long begin = group.offsets[row];
+                    long long length = group.offsets[row + 1] - begin;
+                    if (length > 0) {
+                        std::memmove(&group.bytes[keptBytes], &group.bytes[begin], length);
+                    }
+                    group.offsets[keptRow++] = keptBytes;
+                    keptBytes += length;
+                }
+                group.offsets[keptRow] = keptBytes;
+                group.offsets.resize(keptRow + 1);
+                group.bytes.resize(keptBytes);
+            }
+            group.rows = kept;
+            return kept;
+        }
+
+        /**
+         * Method is used to drop removed rows of typed array of the group,
+         * array not used by the column is empty.
+         */
+        template <class T>
+        static void removeValues(std::vector<T>& values, long long rows,
+                long long start, const CsvRowTombstones& removedRows) {
+            if ((long long) values.size() != rows) return;
+            long long keptRow = 0;
+            for (long long row = 0; row < rows; ++row) {
+                if (!removedRows.isRemoved(start + row)) values[keptRow++] = values[row];
+            }
+            values.resize(keptRow);
+        }
+
+        template <class T>
+        static bool fitsIn(long long minValue, long long maxValue) {
+            return minValue >= std::numeric_limits<T>::min()
+                    && maxValue <= std::numeric_limits<T>::max();
+        }
+
+        /**
+         * Method is used to move integer values to arrays of type T,
+         * memory of the previous arrays is freed.
+         */
+        template <class T>
+        void storeIntegers() {
+            for (RowGroup& group : _groups) {
+                std::vector<T> target(group.rows);
+                for (long long row = 0; row < group.rows; ++row) {
+                    target[row] = (T) getInteger(group, row);
+                }
+                std::vector<int8_t>().swap(group.int8s);
+                std::vector<int16_t>().swap(group.int16s);
+                std::vector<int>().swap(group.ints);
+                std::vector<long long>().swap(group.int64s);
+                valueVector(group, (T*) nullptr).swap(target);
+            }
+            _integerWidth = sizeof (T);
+        }
+
+        /**
+         * Dates and doubles are not integer columns, they are never
+         * narrowed.
+         */
+        static int integerWidth(const void*) {
+            return 0;
+        }
+
+        static int integerWidth(int8_t*) {
+            return sizeof (int8_t);
+        }
+
+        static int integerWidth(int16_t*) {
+            return sizeof (int16_t);
+        }
+
+        static int integerWidth(int*) {
+            return sizeof (int);
+        }
+
+        static int integerWidth(long long*) {
+            return sizeof (long long);
+        }
+
+        static std::vector<int8_t>& valueVector(RowGroup& group, int8_t*) {
+            return group.int8s;
+        }
+
+        static std::vector<int16_t>& valueVector(RowGroup& group, int16_t*) {
+            return group.int16s;
+        }
+
+        static std::vector<int>& valueVector(RowGroup& group, int*) {
+            return group.ints;
+        }
+
+        static std::vector<long long>& valueVector(RowGroup& group, long long*) {
+            return group.int64s;
+        }
+
+        static std::vector<double>& valueVector(RowGroup& group, double*) {
+            return group.doubles;
+        }
+
+        static std::vector<std::time_t>& valueVector(RowGroup& group, CsvDate*) {
+            return group.dates;
+        }
+    };
+}
+
+#endif /* CSVCOLUMNSTORE_HPP */
@@ -0,0 +1,94 @@
+/*
+ * File:   CsvDataSource.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvDataSource.hpp"
+#include "CsvHandlerExceptions.hpp"
+#ifdef CSVH_WITH_DESCRIPTORS
+#include <cerrno>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+using namespace csvh;
+
+CsvFileSource::CsvFileSource(const std::string& fileName)
+: _fileStream(fileName, std::ios::binary) {
+#ifdef CSVH_WITH_DESCRIPTORS
+    // Directory can be opened as a stream here, only its reads fail.
+    struct stat fileStat;
+    if (!_fileStream || stat(fileName.c_str(), &fileStat) == -1
+            || !S_ISREG(fileStat.st_mode)) {
+        throw UnableToOpenFileException();
+    }
+    _fileSize = fileStat.st_size;
+#else
+    _fileStream.seekg(0, std::ios::end);
+    _fileSize = _fileStream.tellg();
+    _fileStream.seekg(0);
+    if (!_fileStream || _fileSize < 0) {
+        throw UnableToOpenFileException();
+    }
+#endif
+}
+
+long long CsvFileSource::read(char* data, long long size) {
+    _fileStream.read(data, size);
+    if (_fileStream.bad()) {
+        throw UnableToOpenFileException();
+    }
+    return _fileStream.gcount();
+}
+
+bool CsvFileSource::rewind() {
+    _fileStream.clear();
+    _fileStream.seekg(0);
+    return !_fileStream.fail();
+}
+
+long long CsvFileSource::size() {
+    return _fileSize;
+}
+
+CsvStreamSource::CsvStreamSource(std::istream& inStream)
+: _inStream(inStream) {
+}
+
+long long CsvStreamSource::read(char* data, long long size) {
+    _inStream.read(data, size);
+    if (_inStream.bad()) {
+        throw UnableToOpenFileException();
+    }
+    return _inStream.gcount();
+}
+
+#ifdef CSVH_WITH_DESCRIPTORS
+
+CsvDescriptorSource::CsvDescriptorSource(int fileDescriptor)
+: _fileDescriptor(fileDescriptor) {
+}
+
+long long CsvDescriptorSource::read(char* data, long long size) {
+    while (true) {
+        ssize_t bytesRead = ::read(_fileDescriptor, data, size);
+        if (bytesRead >= 0) {
+            return bytesRead;
+        } else if (errno != EINTR) {
+            throw UnableToOpenFileException();
+        }
+    }
+}
+
+bool CsvDescriptorSource::rewind() {
+    return lseek(_fileDescriptor, 0, SEEK_SET) == 0;
+}
+
+long long CsvDescriptorSource::size() {
+    struct stat fileStat;
+    if (fstat(_fileDescriptor, &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+        return fileStat.st_size;
+    }
+    return -1;
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+ * File:   CsvDataSource.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVDATASOURCE_HPP
+#define CSVDATASOURCE_HPP
+
+#include <string>
+#include <istream>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CSVH_WITH_DESCRIPTORS
+#endif
+
+namespace csvh {
+
+    /**
+     * Sequential source of input data.
+     * Data is read once from the beginning to the end, without seeks.
+     */
+    class CsvDataSource {
+    public:
+
+        virtual ~CsvDataSource() {
+        }
+
+        /**
+         * Method is used to read next bytes from the source.
+         * It may return less bytes than requested.
+         *
+         * @param data - destination
+         * @param size - maximal amount of bytes to read
+         * @return amount of bytes read, 0 at the end of data
+         */
+        virtual long long read(char* data, long long size) = 0;
+
+        /**
+         * Method is used to start reading again from the beginning.
+         *
+         * @return false if source can not be read again
+         */
+        virtual bool rewind() {
+            return false;
+        }
+
+        /**
+         * Method returns size of the whole source.
+         *
+         * @return size in bytes, -1 if size is not known
+         */
+        virtual long long size() {
+            return -1;
+        }
+    };
+
+    /**
+     * Regular file opened by name.
+     */
+    class CsvFileSource : public CsvDataSource {
+    public:
+
+        /**
+         * Throws UnableToOpenFileException if file can not be opened.
+         *
+         * @param fileName
+         */
+        CsvFileSource(const std::string& fileName);
+
+        virtual long long read(char* data, long long size) override;
+        virtual bool rewind() override;
+        virtual long long size() override;
+
+    private:
+        std::ifstream _fileStream;
+        long long _fileSize;
+    };
+
+    /**
+     * Any std::istream, e.g. std::cin or decompressing stream.
+     * Stream is not owned and has to outlive the source.
+     */
+    class CsvStreamSource : public CsvDataSource {
+    public:
+
+        CsvStreamSource(std::istream& inStream);
+
+        virtual long long read(char* data, long long size) override;
+
+    private:
+        std::istream& _inStream;
+    };
+
+#ifdef CSVH_WITH_DESCRIPTORS
+
+    /**
+     * File descriptor, e.g. pipe or STDIN_FILENO.
+     * Descriptor is not closed by the source.
+     * Available on POSIX systems only (CSVH_WITH_DESCRIPTORS is defined).
+     */
+    class CsvDescriptorSource : public CsvDataSource {
+    public:
+
+        CsvDescriptorSource(int fileDescriptor);
+
+        virtual long long read(char* data, long long size) override;
+        virtual bool rewind() override;
+        virtual long long size() override;
+
+    private:
+        int _fileDescriptor;
+    };
+#endif
+}
+
+#endif /* CSVDATASOURCE_HPP */
@@ -0,0 +1,501 @@
+/*
+ * File:   CsvDateFormat.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvDateFormat.hpp"
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CSVH_POSIX_TIME
+#else
+#include <sstream>
+#include <iomanip>
+#include <locale>
+#ifndef _WIN32
+#include <mutex>
+#endif
+#endif
+
+using namespace csvh;
+
+namespace {
+
+    const long long _secondsPerDay = 24 * 60 * 60;
+
+    /**
+     * Timezones change their UTC offset at quarter-hour boundaries.
+     */
+    const long long _secondsPerOffsetSlice = 15 * 60;
+    const int _conversionBufferSize = 128;
+
+    /**
+     * Values kept in the day cache for days not looked up yet and for
+     * days when the offset changes.
+     */
+    const int32_t _offsetUnknown = INT32_MAX;
+    const int32_t _offsetChanges = INT32_MIN;
+
+    inline bool isWhitespace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    inline bool isLeapYear(long long year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    unsigned int daysInMonth(long long year, unsigned int month) {
+        static const unsigned int days[] = {
+            31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+        };
+        return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+    }
+
+    /**
+     * Reads at most maxDigits digits, at least one is required.
+     */
+    bool readNumber(const char*& current, const char* end, int maxDigits,
+            int& value) {
+        const char* numberBegin = current;
+        value = 0;
+        while (current < end && current - numberBegin < maxDigits
+                && *current >= '0' && *current <= '9') {
+            value = value * 10 + (*current - '0');
+            ++current;
+        }
+        return current != numberBegin;
+    }
+
+    inline long long floorDivide(long long value, long long divisor) {
+        long long quotient = value / divisor;
+        return value % divisor < 0 ? quotient - 1 : quotient;
+    }
+
+    bool toLocalTime(std::time_t value, std::tm& dateTime) {
+#if defined(CSVH_POSIX_TIME)
+        return localtime_r(&value, &dateTime) != nullptr;
+#elif defined(_WIN32)
+        return localtime_s(&dateTime, &value) == 0;
+#else
+        static std::mutex localTimeMutex;
+        std::lock_guard<std::mutex> lock(localTimeMutex);
+        std::tm* localDateTime = std::localtime(&value);
+        if (localDateTime != nullptr) dateTime = *localDateTime;
+        return localDateTime != nullptr;
+#endif
+    }
+
+    /**
+     * Asks the timezone database for UTC offset, local time minus UTC.
+     *
+     * @param seconds - local time as seconds since epoch, or UTC
+     *        seconds since epoch when fromLocalTime is false
+     */
+    long long lookUpUtcOffset(long long seconds, bool fromLocalTime) {
+        std::tm dateTime;
+        memset(&dateTime, 0, sizeof (dateTime));
+        if (fromLocalTime) {
+            long long days = floorDivide(seconds, _secondsPerDay);
+            long long daySeconds = seconds - days * _secondsPerDay;
+            long long year;
+            unsigned int month, day;
+            CsvDateFormat::civilFromDays(days, year, month, day);
+            dateTime.tm_year = year - 1900;
+            dateTime.tm_mon = month - 1;
+            dateTime.tm_mday = day;
+            dateTime.tm_hour = daySeconds / 3600;
+            dateTime.tm_min = daySeconds / 60 % 60;
+            dateTime.tm_sec = daySeconds % 60;
+            dateTime.tm_isdst = -1;
+            return seconds - (long long) std::mktime(&dateTime);
+        }
+
+        if (!toLocalTime(seconds, dateTime)) return 0;
+        long long localDays = CsvDateFormat::daysFromCivil(
+                dateTime.tm_year + 1900, dateTime.tm_mon + 1, dateTime.tm_mday);
+        return localDays * _secondsPerDay + dateTime.tm_hour * 3600
+                + dateTime.tm_min * 60 + dateTime.tm_sec - seconds;
+    }
+
+    /**
+     * Returns page of the day cache, allocated on first use. Thread which
+     * loses the race for the page releases its own copy.
+     */
+    std::atomic<int32_t>* getOffsetPage(
+            std::atomic<std::atomic<int32_t>*>& pagePointer, int pageSize) {
+        std::atomic<int32_t>* page = pagePointer.load(std::memory_order_acquire);
+        if (page != nullptr) return page;
+
+        std::atomic<int32_t>* newPage = new std::atomic<int32_t>[pageSize];
+        for (int day = 0; day < pageSize; ++day) {
+            newPage[day].store(_offsetUnknown, std::memory_order_relaxed);
+        }
+        if (pagePointer.compare_exchange_strong(page, newPage,
+                std::memory_order_acq_rel)) {
+            return newPage;
+        }
+        delete[] newPage;
+        return page;
+    }
+
+    void appendNumber(std::string& text, long long value, int digits) {
+        char buffer[24];
+        int length = 0;
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? -value : value;
+        do {
+            buffer[length++] = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude != 0 || length < digits);
+        if (negative) text += '-';
+        while (length > 0) text += buffer[--length];
+    }
+}
+
+CsvDateFormat::CsvDateFormat(const std::string& dateFormat)
+: _dateFormat(dateFormat), _compiled(true) {
+    initializeCaches();
+    compile();
+}
+
+CsvDateFormat::CsvDateFormat(const CsvDateFormat& other)
+: _dateFormat(other._dateFormat), _tokens(other._tokens),
+_compiled(other._compiled) {
+    initializeCaches();
+}
+
+CsvDateFormat& CsvDateFormat::operator=(const CsvDateFormat& other) {
+    if (this == &other) return *this;
+    _dateFormat = other._dateFormat;
+    _tokens = other._tokens;
+    _compiled = other._compiled;
+    releaseCaches();
+    initializeCaches();
+    return *this;
+}
+
+CsvDateFormat::~CsvDateFormat() {
+    releaseCaches();
+}
+
+void CsvDateFormat::initializeCaches() {
+    _monthCache.store(0, std::memory_order_relaxed);
+    for (int page = 0; page < _amountOfOffsetPages; ++page) {
+        _localOffsetPages[page].store(nullptr, std::memory_order_relaxed);
+        _utcOffsetPages[page].store(nullptr, std::memory_order_relaxed);
+    }
+    _localSliceCache.store(0, std::memory_order_relaxed);
+    _utcSliceCache.store(0, std::memory_order_relaxed);
+}
+
+void CsvDateFormat::releaseCaches() {
+    for (int page = 0; page < _amountOfOffsetPages; ++page) {
+        delete[] _localOffsetPages[page].load(std::memory_order_relaxed);
+        delete[] _utcOffsetPages[page].load(std::memory_order_relaxed);
+    }
+}
+
+const CsvDateFormat& CsvDateFormat::getDefaultFormat() {
+    static const CsvDateFormat defaultFormat;
+    return defaultFormat;
+}
+
+void CsvDateFormat::addToken(_tokenKind kind, char literal) {
+    FormatToken token = {kind, literal};
+    _tokens.push_back(token);
+}
+
+void CsvDateFormat::compile() {
+    for (size_t pos = 0; pos < _dateFormat.size() && _compiled; ++pos) {
+        char c = _dateFormat[pos];
+        if (isWhitespace(c)) {
+            addToken(token_whitespace, c);
+            continue;
+        } else if (c != '%') {
+            addToken(token_literal, c);
+            continue;
+        } else if (++pos == _dateFormat.size()) {
+            _compiled = false;
+            break;
+        }
+
+        switch (_dateFormat[pos]) {
+            case 'Y': addToken(token_year);
+                break;
+            case 'y': addToken(token_short_year);
+                break;
+            case 'm': addToken(token_month);
+                break;
+            case 'd': addToken(token_day);
+                break;
+            case 'e': addToken(token_space_padded_day);
+                break;
+            case 'H': addToken(token_hour);
+                break;
+            case 'M': addToken(token_minute);
+                break;
+            case 'S': addToken(token_second);
+                break;
+            case 'F':
+                addToken(token_year);
+                addToken(token_literal, '-');
+                addToken(token_month);
+                addToken(token_literal, '-');
+                addToken(token_day);
+                break;
+            case 'T':
+                addToken(token_hour);
+                addToken(token_literal, ':');
+                addToken(token_minute);
+                addToken(token_literal, ':');
+                addToken(token_second);
+                break;
+            case '%': addToken(token_literal, '%');
+                break;
+            default:
+                _compiled = false;
+                break;
+        }
+    }
+    if (!_compiled) _tokens.clear();
+}
+
+_parseStatus CsvDateFormat::parse(const char* begin, const char* end,
+        std::time_t& value) const {
+    if (!_compiled) return parseWithStrptime(begin, end, value);
+
+    int year = 1970, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+    const char* current = begin;
+    for (const FormatToken& token : _tokens) {
+        bool matched = true;
+        switch (token.kind) {
+            case token_literal:
+                matched = current < end && *current == token.literal;
+                if (matched) ++current;
+                break;
+            case token_whitespace:
+                while (current < end && isWhitespace(*current)) ++current;
+                break;
+            case token_year:
+                matched = readNumber(current, end, 4, year);
+                break;
+            case token_short_year:
+                matched = readNumber(current, end, 2, year);
+                year += year < 69 ? 2000 : 1900;
+                break;
+            case token_month:
+                matched = readNumber(current, end, 2, month);
+                break;
+            case token_day:
+            case token_space_padded_day:
+                if (current < end && *current == ' ') ++current;
+                matched = readNumber(current, end, 2, day);
+                break;
+            case token_hour:
+                matched = readNumber(current, end, 2, hour);
+                break;
+            case token_minute:
+                matched = readNumber(current, end, 2, minute);
+                break;
+            case token_second:
+                matched = readNumber(current, end, 2, second);
+                break;
+        }
+        if (!matched) return parse_invalid_argument;
+    }
+
+    if (current != end) {
+        return parse_type_not_correct;
+    } else if (month < 1 || month > 12 || day < 1
+            || day > (int) daysInMonth(year, month)
+            || hour > 23 || minute > 59 || second > 60) {
+        return parse_out_of_range;
+    }
+    long long localValue = cachedDaysFromCivil(year, month, day) * _secondsPerDay
+            + hour * 3600 + minute * 60 + second;
+    value = localValue - cachedUtcOffset(localValue, true);
+    return parse_ok;
+}
+
+std::string CsvDateFormat::format(std::time_t value) const {
+    if (!_compiled) {
+        std::tm dateTime;
+        char buffer[_conversionBufferSize];
+        if (!toLocalTime(value, dateTime)) return std::string();
+        size_t length = strftime(buffer, sizeof (buffer), _dateFormat.c_str(),
+                &dateTime);
+        return std::string(buffer, length);
+    }
+
+    long long localValue = value + cachedUtcOffset(value, false);
+    long long days = localValue / _secondsPerDay;
+    long long seconds = localValue % _secondsPerDay;
+    if (seconds < 0) {
+        seconds += _secondsPerDay;
+        --days;
+    }
+
+    long long year;
+    unsigned int month, day;
+    civilFromDays(days, year, month, day);
+    std::string text;
+    text.reserve(_tokens.size() * 2);
+    for (const FormatToken& token : _tokens) {
+        switch (token.kind) {
+            case token_literal:
+            case token_whitespace:
+                text += token.literal;
+                break;
+            case token_year: appendNumber(text, year, 4);
+                break;
+            case token_short_year: appendNumber(text, year % 100, 2);
+                break;
+            case token_month: appendNumber(text, month, 2);
+                break;
+            case token_day: appendNumber(text, day, 2);
+                break;
+            case token_space_padded_day:
+                if (day < 10) text += ' ';
+                appendNumber(text, day, 1);
+                break;
+            case token_hour: appendNumber(text, seconds / 3600, 2);
+                break;
+            case token_minute: appendNumber(text, seconds / 60 % 60, 2);
+                break;
+            case token_second: appendNumber(text, seconds % 60, 2);
+                break;
+        }
+    }
+    return text;
+}
+
+long long CsvDateFormat::cachedDaysFromCivil(long long year,
+        unsigned int month, unsigned int day) const {
+    // Timestamps in a file are usually close to each other, so the first
+    // day of the month is looked up once and shared by following dates.
+    uint64_t monthKey = (uint64_t) (year + 1000000) * 16 + month;
+    uint64_t cached = _monthCache.load(std::memory_order_relaxed);
+    long long monthStart;
+    if ((cached >> 32) == monthKey) {
+        monthStart = (int32_t) (uint32_t) cached;
+    } else {
+        monthStart = daysFromCivil(year, month, 1);
+        if (monthKey < (1ULL << 32) && monthStart >= INT32_MIN
+                && monthStart <= INT32_MAX) {
+            _monthCache.store((monthKey << 32) | (uint32_t) monthStart,
+                    std::memory_order_relaxed);
+        }
+    }
+    return monthStart + day - 1;
+}
+
+long long CsvDateFormat::cachedUtcOffset(long long seconds,
+        bool fromLocalTime) const {
+    long long day = floorDivide(seconds, _secondsPerDay);
+    long long cachedDays = (long long) _amountOfOffsetPages * _daysPerOffsetPage;
+    long long dayIndex = day + cachedDays / 2;
+    if (dayIndex < 0 || dayIndex >= cachedDays) {
+        return cachedSliceOffset(seconds, fromLocalTime);
+    }
+
+    std::atomic<std::atomic<int32_t>*>* pages = fromLocalTime ?
+            _localOffsetPages : _utcOffsetPages;
+    std::atomic<int32_t>& cachedOffset = getOffsetPage(
+            pages[dayIndex / _daysPerOffsetPage], _daysPerOffsetPage)
+            [dayIndex % _daysPerOffsetPage];
+    int32_t offset = cachedOffset.load(std::memory_order_relaxed);
+    if (offset == _offsetUnknown) {
+        // Offset changes at most once a day, so a day which starts and
+        // ends with the same offset keeps it all day long.
+        long long dayStart = day * _secondsPerDay;
+        long long startOffset = lookUpUtcOffset(dayStart, fromLocalTime);
+        offset = startOffset == lookUpUtcOffset(dayStart + _secondsPerDay,
+                fromLocalTime) ? (int32_t) startOffset : _offsetChanges;
+        cachedOffset.store(offset, std::memory_order_relaxed);
+    }
+    return offset != _offsetChanges ? offset
+            : cachedSliceOffset(seconds, fromLocalTime);
+}
+
+long long CsvDateFormat::cachedSliceOffset(long long seconds,
+        bool fromLocalTime) const {
+    std::atomic<uint64_t>& offsetCache = fromLocalTime ? _localSliceCache
+            : _utcSliceCache;
+    long long slice = floorDivide(seconds, _secondsPerOffsetSlice);
+    // Key 0 marks empty cache, slices out of 32 bits are not cached.
+    uint64_t sliceKey = (uint64_t) (slice + (1LL << 31));
+    bool cacheable = sliceKey != 0 && sliceKey < (1ULL << 32);
+    uint64_t cached = offsetCache.load(std::memory_order_relaxed);
+    if (cacheable && (cached >> 32) == sliceKey) {
+        return (int32_t) (uint32_t) cached;
+    }
+
+    long long offset = lookUpUtcOffset(slice * _secondsPerOffsetSlice,
+            fromLocalTime);
+    if (cacheable) {
+        offsetCache.store((sliceKey << 32) | (uint32_t) offset,
+                std::memory_order_relaxed);
+    }
+    return offset;
+}
+
+long long CsvDateFormat::daysFromCivil(long long year, unsigned int month,
+        unsigned int day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned int yearOfEra = year - era * 400;
+    unsigned int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100
+            + dayOfYear;
+    return era * 146097 + (long long) dayOfEra - 719468;
+}
+
+void CsvDateFormat::civilFromDays(long long days, long long& year,
+        unsigned int& month, unsigned int& day) {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned int dayOfEra = days - era * 146097;
+    unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+            - dayOfEra / 146096) / 365;
+    unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4
+            - yearOfEra / 100);
+    unsigned int monthIndex = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+_parseStatus CsvDateFormat::parseWithStrptime(const char* begin,
+        const char* end, std::time_t& value) const {
+    char buffer[_conversionBufferSize];
+    size_t length = end - begin;
+    if (length >= (size_t) _conversionBufferSize) {
+        return parse_type_not_correct;
+    }
+    memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+
+    std::tm parsedValue;
+    memset(&parsedValue, 0, sizeof (parsedValue));
+    parsedValue.tm_mday = 1;
+    parsedValue.tm_isdst = -1;
+#ifdef CSVH_POSIX_TIME
+    const char* parsedEnd = strptime(buffer, _dateFormat.c_str(), &parsedValue);
+    if (parsedEnd == nullptr) {
+        return parse_invalid_argument;
+    } else if (parsedEnd != buffer + length) {
+        return parse_type_not_correct;
+    }
+#else
+    std::istringstream dateStream(std::string(buffer, length));
+    dateStream.imbue(std::locale::classic());
+    dateStream >> std::get_time(&parsedValue, _dateFormat.c_str());
+    if (dateStream.fail()) {
+        return parse_invalid_argument;
+    } else if (dateStream.peek() != std::char_traits<char>::eof()) {
+        return parse_type_not_correct;
+    }
+#endif
+    value = std::mktime(&parsedValue);
+    return parse_ok;
+}
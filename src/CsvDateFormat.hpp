@@ -0,0 +1,176 @@
+/*
+ * File:   CsvDateFormat.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVDATEFORMAT_HPP
+#define CSVDATEFORMAT_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <ctime>
+#include <cstdint>
+#include "CsvEntryElement.hpp"
+#include "CsvFieldParser.hpp"
+
+namespace csvh {
+
+    /**
+     * Date format compiled from strptime-like format string.
+     * Supported specifiers: %Y %y %m %d %e %H %M %S %F %T %%, whitespace
+     * matches any amount of whitespace. Other formats are handled by
+     * strptime, or std::get_time where strptime is not available.
+     * Dates are local time, as with std::mktime. Fields are converted to
+     * seconds without the timezone database, which is asked for the UTC
+     * offset twice per day of dates, and once per quarter of an hour
+     * only on days when the offset changes.
+     */
+    class CsvDateFormat {
+    public:
+
+        CsvDateFormat(const std::string& dateFormat = "%Y-%m-%d %H:%M:%S");
+        CsvDateFormat(const CsvDateFormat& other);
+        CsvDateFormat& operator=(const CsvDateFormat& other);
+        ~CsvDateFormat();
+
+        /**
+         * Method is used to convert text to seconds since epoch.
+         *
+         * @param begin
+         * @param end
+         * @param value - set only when parse_ok is returned
+         * @return conversion status
+         */
+        _parseStatus parse(const char* begin, const char* end,
+                std::time_t& value) const;
+
+        /**
+         * Method is used to convert seconds since epoch to text.
+         *
+         * @param value
+         * @return date in this format
+         */
+        std::string format(std::time_t value) const;
+
+        const std::string& getFormat() const {
+            return _dateFormat;
+        }
+
+        /**
+         * Method returns format used when none is given.
+         *
+         * @return "%Y-%m-%d %H:%M:%S" format
+         */
+        static const CsvDateFormat& getDefaultFormat();
+
+        /**
+         * Methods convert between days since epoch and civil date
+         * in proleptic Gregorian calendar.
+         */
+        static long long daysFromCivil(long long year, unsigned int month,
+                unsigned int day);
+        static void civilFromDays(long long days, long long& year,
+                unsigned int& month, unsigned int& day);
+
+    private:
+
+        enum _tokenKind {
+            token_literal,
+            token_whitespace,
+            token_year,
+            token_short_year,
+            token_month,
+            token_day,
+            token_space_padded_day,
+            token_hour,
+            token_minute,
+            token_second
+        };
+
+        struct FormatToken {
+            _tokenKind kind;
+            char literal;
+        };
+
+        std::string _dateFormat;
+        std::vector<FormatToken> _tokens;
+
+        /**
+         * Flag is set when format contains only supported specifiers.
+         */
+        bool _compiled;
+
+        /**
+         * Days since epoch for the first day of the last parsed month,
+         * packed with the month key, so that lookups are lock-free.
+         */
+        mutable std::atomic<uint64_t> _monthCache;
+
+        static const int _daysPerOffsetPage = 512;
+        static const int _amountOfOffsetPages = 256;
+
+        /**
+         * UTC offsets of days from 1790 to 2149, indexed by day in pages
+         * allocated on first use, so that threads parsing different time
+         * ranges and unsorted dates share them without locks. Separate
+         * pages are kept for local time being parsed and for seconds since
+         * epoch being formatted.
+         */
+        mutable std::atomic<std::atomic<int32_t>*> _localOffsetPages[_amountOfOffsetPages];
+        mutable std::atomic<std::atomic<int32_t>*> _utcOffsetPages[_amountOfOffsetPages];
+
+        /**
+         * UTC offset of the last looked up quarter of an hour of a day
+         * when the offset changes, packed with the quarter key.
+         */
+        mutable std::atomic<uint64_t> _localSliceCache;
+        mutable std::atomic<uint64_t> _utcSliceCache;
+
+        void compile();
+        void addToken(_tokenKind kind, char literal = 0);
+
+        long long cachedDaysFromCivil(long long year, unsigned int month,
+                unsigned int day) const;
+
+        /**
+         * Method returns UTC offset in seconds.
+         *
+         * @param seconds - local time as seconds since epoch, or UTC
+         *        seconds since epoch when fromLocalTime is false
+         * @param fromLocalTime
+         * @return local time minus UTC
+         */
+        long long cachedUtcOffset(long long seconds, bool fromLocalTime) const;
+
+        long long cachedSliceOffset(long long seconds, bool fromLocalTime) const;
+
+        void initializeCaches();
+        void releaseCaches();
+
+        _parseStatus parseWithStrptime(const char* begin, const char* end,
+                std::time_t& value) const;
+    };
+
+    /**
+     * Field of type_date column. Value is stored as seconds since epoch
+     * and printed in the format it was read with.
+     */
+    class CsvDateEntryElement : public CsvTypedEntryElement<std::time_t> {
+    public:
+
+        CsvDateEntryElement(const CsvDateFormat* dateFormat = nullptr)
+        : _dateFormat(dateFormat != nullptr ? dateFormat
+        : &CsvDateFormat::getDefaultFormat()) {
+        }
+
+        virtual std::string getStringValue() override {
+            return _dateFormat->format(getValue());
+        }
+
+    private:
+        const CsvDateFormat* _dateFormat;
+    };
+}
+
+#endif /* CSVDATEFORMAT_HPP */
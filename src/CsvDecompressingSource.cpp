@@ -0,0 +1,291 @@
+/*
+ * File:   CsvDecompressingSource.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvDecompressingSource.hpp"
+#include "CsvHandlerExceptions.hpp"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#ifdef CSVH_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CSVH_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace csvh;
+
+CsvDecompressingSource::CsvDecompressingSource(CsvDataSource* compressedSource,
+        _compressionFormat compressionFormat)
+: _compressedSource(compressedSource),
+_compressionFormatFlag(compressionFormat) {
+#ifndef CSVH_WITH_ZLIB
+    if (compressionFormat == gzip_compression) {
+        delete compressedSource;
+        throw UnsupportedCompressionException();
+    }
+#endif
+#ifndef CSVH_WITH_ZSTD
+    if (compressionFormat == zstd_compression) {
+        delete compressedSource;
+        throw UnsupportedCompressionException();
+    }
+#endif
+    _readPosition = 0;
+    _endOfData = false;
+    _stopFlag = false;
+    _decompressingThread = std::thread(&CsvDecompressingSource::decompressLoop, this);
+}
+
+CsvDecompressingSource::~CsvDecompressingSource() {
+    stopDecompressing();
+    delete _compressedSource;
+}
+
+void CsvDecompressingSource::stopDecompressing() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopFlag = true;
+    }
+    _blockReleased.notify_one();
+    if (_decompressingThread.joinable()) _decompressingThread.join();
+}
+
+bool CsvDecompressingSource::rewind() {
+    stopDecompressing();
+    while (!_filledBlocks.empty()) {
+        _freeBlocks.push_back(std::vector<char>());
+        _freeBlocks.back().swap(_filledBlocks.front());
+        _filledBlocks.pop_front();
+    }
+    _readPosition = 0;
+    _decompressError = std::exception_ptr();
+    if (!_compressedSource->rewind()) {
+        // Source stays at end of data, reads return 0.
+        _endOfData = true;
+        return false;
+    }
+    _endOfData = false;
+    _stopFlag = false;
+    _decompressingThread = std::thread(&CsvDecompressingSource::decompressLoop, this);
+    return true;
+}
+
+long long CsvDecompressingSource::read(char* data, long long size) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _blockFilled.wait(lock, [this]() {
+        return !_filledBlocks.empty() || _endOfData;
+    });
+    if (_filledBlocks.empty()) {
+        if (_decompressError) {
+            std::rethrow_exception(_decompressError);
+        }
+        return 0;
+    }
+
+    // References to deque elements stay valid while producer appends blocks.
+    std::vector<char>& block = _filledBlocks.front();
+    lock.unlock();
+    long long bytesRead = std::min(size, (long long) (block.size() - _readPosition));
+    memcpy(data, &block[_readPosition], bytesRead);
+    _readPosition += bytesRead;
+    lock.lock();
+
+    if (_readPosition == block.size()) {
+        _freeBlocks.push_back(std::vector<char>());
+        _freeBlocks.back().swap(block);
+        _filledBlocks.pop_front();
+        _readPosition = 0;
+        _blockReleased.notify_one();
+    }
+    return bytesRead;
+}
+
+_compressionFormat CsvDecompressingSource::detectCompression(
+        const std::string& fileName) {
+    unsigned char magic[4] = {0, 0, 0, 0};
+    std::ifstream file(fileName, std::ios::binary);
+    file.read(reinterpret_cast<char*> (magic), sizeof (magic));
+
+    if (file.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return gzip_compression;
+    } else if (file.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5
+            && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return zstd_compression;
+    }
+    return no_compression;
+}
+
+bool CsvDecompressingSource::acquireBlock(std::vector<char>& block) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _blockReleased.wait(lock, [this]() {
+        return _stopFlag || _filledBlocks.size() < _maxQueuedBlocks;
+    });
+    if (_stopFlag) return false;
+
+    if (!_freeBlocks.empty()) {
+        block.swap(_freeBlocks.back());
+        _freeBlocks.pop_back();
+    }
+    block.resize(_blockSize);
+    return true;
+}
+
+void CsvDecompressingSource::pushBlock(std::vector<char>& block, long long size) {
+    if (size == 0) return;
+    block.resize(size);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _filledBlocks.push_back(std::vector<char>());
+    _filledBlocks.back().swap(block);
+    _blockFilled.notify_one();
+}
+
+void CsvDecompressingSource::decompressLoop() {
+    try {
+        if (_compressionFormatFlag == gzip_compression) {
+            decompressGzip();
+        } else if (_compressionFormatFlag == zstd_compression) {
+            decompressZstd();
+        } else {
+            std::vector<char> block;
+            while (acquireBlock(block)) {
+                long long bytesRead = _compressedSource->read(&block[0], _blockSize);
+                if (bytesRead == 0) break;
+                pushBlock(block, bytesRead);
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decompressError = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _endOfData = true;
+    }
+    _blockFilled.notify_one();
+}
+
+void CsvDecompressingSource::decompressGzip() {
+#ifdef CSVH_WITH_ZLIB
+    z_stream stream;
+    memset(&stream, 0, sizeof (stream));
+    // 15 + 32 - maximal window, gzip or zlib header detected automatically.
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw UnableToDecompressSourceException();
+    }
+
+    std::vector<char> input(_blockSize);
+    std::vector<char> block;
+    long long blockUsed = 0;
+    bool anyInput = false;
+    bool memberEnd = false;
+    bool outputFull = false;
+
+    try {
+        if (!acquireBlock(block)) {
+            inflateEnd(&stream);
+            return;
+        }
+        while (true) {
+            if (stream.avail_in == 0 && !outputFull) {
+                long long bytesRead = _compressedSource->read(&input[0], _blockSize);
+                if (bytesRead == 0) break;
+                stream.next_in = reinterpret_cast<Bytef*> (&input[0]);
+                stream.avail_in = bytesRead;
+                anyInput = true;
+            }
+
+            stream.next_out = reinterpret_cast<Bytef*> (&block[blockUsed]);
+            stream.avail_out = _blockSize - blockUsed;
+            int result = inflate(&stream, Z_NO_FLUSH);
+            if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+                throw UnableToDecompressSourceException();
+            }
+            blockUsed = _blockSize - stream.avail_out;
+            outputFull = stream.avail_out == 0;
+            if (result != Z_BUF_ERROR) memberEnd = result == Z_STREAM_END;
+            // Concatenated gzip members are decompressed one after another.
+            if (result == Z_STREAM_END) inflateReset(&stream);
+
+            if (outputFull) {
+                pushBlock(block, blockUsed);
+                blockUsed = 0;
+                if (!acquireBlock(block)) {
+                    inflateEnd(&stream);
+                    return;
+                }
+            }
+        }
+        pushBlock(block, blockUsed);
+    } catch (...) {
+        inflateEnd(&stream);
+        throw;
+    }
+    inflateEnd(&stream);
+    if (anyInput && !memberEnd) {
+        throw UnableToDecompressSourceException();
+    }
+#endif
+}
+
+void CsvDecompressingSource::decompressZstd() {
+#ifdef CSVH_WITH_ZSTD
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (stream == nullptr || ZSTD_isError(ZSTD_initDStream(stream))) {
+        ZSTD_freeDStream(stream);
+        throw UnableToDecompressSourceException();
+    }
+
+    std::vector<char> input(ZSTD_DStreamInSize());
+    ZSTD_inBuffer inBuffer = {&input[0], 0, 0};
+    std::vector<char> block;
+    long long blockUsed = 0;
+    size_t lastResult = 0;
+    bool outputFull = false;
+
+    try {
+        if (!acquireBlock(block)) {
+            ZSTD_freeDStream(stream);
+            return;
+        }
+        while (true) {
+            if (inBuffer.pos == inBuffer.size && !outputFull) {
+                long long bytesRead = _compressedSource->read(&input[0], input.size());
+                if (bytesRead == 0) break;
+                inBuffer.size = bytesRead;
+                inBuffer.pos = 0;
+            }
+
+            ZSTD_outBuffer outBuffer = {&block[blockUsed],
+                (size_t) (_blockSize - blockUsed), 0};
+            lastResult = ZSTD_decompressStream(stream, &outBuffer, &inBuffer);
+            if (ZSTD_isError(lastResult)) {
+                throw UnableToDecompressSourceException();
+            }
+            blockUsed += outBuffer.pos;
+            outputFull = blockUsed == _blockSize;
+
+            if (outputFull) {
+                pushBlock(block, blockUsed);
+                blockUsed = 0;
+                if (!acquireBlock(block)) {
+                    ZSTD_freeDStream(stream);
+                    return;
+                }
+            }
+        }
+        pushBlock(block, blockUsed);
+    } catch (...) {
+        ZSTD_freeDStream(stream);
+        throw;
+    }
+    ZSTD_freeDStream(stream);
+    // Non zero result means that last frame was not finished.
+    if (lastResult != 0) {
+        throw UnableToDecompressSourceException();
+    }
+#endif
+}
@@ -0,0 +1,124 @@
+/*
+ * File:   CsvDecompressingSource.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVDECOMPRESSINGSOURCE_HPP
+#define CSVDECOMPRESSINGSOURCE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "CsvDataSource.hpp"
+
+namespace csvh {
+
+    /**
+     * Enum to represent compression of input data.
+     * gzip requires CSVH_WITH_ZLIB and zstd requires CSVH_WITH_ZSTD
+     * to be defined at build time.
+     */
+    enum _compressionFormat {
+        no_compression,
+        gzip_compression,
+        zstd_compression
+    };
+
+    /**
+     * Source decompressing data read from another source.
+     * Decompression runs in a background thread and fills a small queue
+     * of blocks, so only a few blocks of inflated data are held in memory.
+     */
+    class CsvDecompressingSource : public CsvDataSource {
+    public:
+
+        /**
+         * Throws UnsupportedCompressionException if library was built
+         * without support for given format.
+         *
+         * @param compressedSource - owned and deleted by this source
+         * @param compressionFormat - gzip_compression / zstd_compression
+         */
+        CsvDecompressingSource(CsvDataSource* compressedSource,
+                _compressionFormat compressionFormat);
+
+        virtual ~CsvDecompressingSource();
+
+        virtual long long read(char* data, long long size) override;
+
+        /**
+         * Method is used to start decompression again from the beginning
+         * of compressed source, blocks decompressed so far are dropped.
+         *
+         * @return false if compressed source can not be read again
+         */
+        virtual bool rewind() override;
+
+        /**
+         * Method is used to detect compression from file magic bytes.
+         *
+         * @param fileName
+         * @return detected compression format
+         */
+        static _compressionFormat detectCompression(const std::string& fileName);
+
+    private:
+
+        static const long long _blockSize = 1024 * 1024;
+        static const unsigned int _maxQueuedBlocks = 4;
+
+        CsvDataSource* _compressedSource;
+        _compressionFormat _compressionFormatFlag;
+
+        std::deque<std::vector<char> > _filledBlocks;
+        std::vector<std::vector<char> > _freeBlocks;
+        unsigned long _readPosition;
+        bool _endOfData;
+        bool _stopFlag;
+
+        std::thread _decompressingThread;
+        std::mutex _mutex;
+        std::condition_variable _blockFilled;
+        std::condition_variable _blockReleased;
+        std::exception_ptr _decompressError;
+
+        /**
+         * Body of the background thread.
+         */
+        void decompressLoop();
+
+        /**
+         * Method is used to stop and join the background thread.
+         */
+        void stopDecompressing();
+
+        void decompressGzip();
+        void decompressZstd();
+
+        /**
+         * Method is used to get an empty block of _blockSize bytes.
+         * Waits while queue of decompressed blocks is full.
+         *
+         * @param block
+         * @return false if source is being destroyed
+         */
+        bool acquireBlock(std::vector<char>& block);
+
+        /**
+         * Method is used to add decompressed block to the queue.
+         *
+         * @param block
+         * @param size - amount of decompressed bytes in block
+         */
+        void pushBlock(std::vector<char>& block, long long size);
+
+        CsvDecompressingSource(const CsvDecompressingSource&);
+        CsvDecompressingSource& operator=(const CsvDecompressingSource&);
+    };
+}
+
+#endif /* CSVDECOMPRESSINGSOURCE_HPP */
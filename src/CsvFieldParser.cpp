@@ -0,0 +1,226 @@
+/*
+ * File:   CsvFieldParser.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvFieldParser.hpp"
+#include "CsvHandlerExceptions.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <clocale>
+
+#if defined(_WIN32)
+#define CSVH_MSVCRT_LOCALE
+#elif defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#define CSVH_POSIX_LOCALE
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#endif
+
+using namespace csvh;
+
+namespace {
+
+    inline bool isWhitespace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    /**
+     * Powers of ten exactly representable as double.
+     */
+    const double _exactPowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int _maxExactPowerOfTen = 22;
+    const uint64_t _maxExactMantissa = 1ULL << 53;
+    const int _maxMantissaDigits = 19;
+
+    template <class T>
+    _parseStatus parseInteger(const char* begin, const char* end, T& value) {
+        const char* current = begin;
+        while (current < end && isWhitespace(*current)) ++current;
+
+        bool negative = false;
+        if (current < end && (*current == '-' || *current == '+')) {
+            negative = *current == '-';
+            ++current;
+        }
+        if (current == end || !isDigit(*current)) {
+            return parse_invalid_argument;
+        }
+
+        // Limit is one more for negative numbers, e.g. -2147483648.
+        unsigned long long limit = (unsigned long long) std::numeric_limits<T>::max()
+                + (negative ? 1 : 0);
+        unsigned long long parsedValue = 0;
+        bool outOfRange = false;
+        for (; current < end && isDigit(*current); ++current) {
+            unsigned int digit = *current - '0';
+            if (parsedValue > (limit - digit) / 10) {
+                outOfRange = true;
+            } else {
+                parsedValue = parsedValue * 10 + digit;
+            }
+        }
+        if (outOfRange) {
+            return parse_out_of_range;
+        } else if (current != end) {
+            return parse_type_not_correct;
+        }
+        value = negative ? (T) (0 - parsedValue) : (T) parsedValue;
+        return parse_ok;
+    }
+
+    /**
+     * Conversion with ISO C strtod, which uses decimal point of current
+     * locale: '.' is replaced by it and text is cut at the locale's own
+     * decimal point, so that only "C" numbers are accepted.
+     */
+    double strtodWithLocaleDecimalPoint(char* text, char** parsedEnd) {
+        const char* localeDecimalPoint = std::localeconv()->decimal_point;
+        char decimalPoint = localeDecimalPoint[0];
+        if (decimalPoint != '.' && decimalPoint != '\0'
+                && localeDecimalPoint[1] == '\0') {
+            char* localePoint = strchr(text, decimalPoint);
+            if (localePoint != nullptr) *localePoint = '\0';
+            char* point = strchr(text, '.');
+            if (point != nullptr) *point = decimalPoint;
+        }
+        return strtod(text, parsedEnd);
+    }
+
+    /**
+     * Conversion with strtod as if "C" locale was set, without changing
+     * locale of the process.
+     */
+    double strtodInCLocale(char* text, char** parsedEnd) {
+#if defined(CSVH_POSIX_LOCALE)
+        static locale_t locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+        if (locale != (locale_t) 0) return strtod_l(text, parsedEnd, locale);
+#elif defined(CSVH_MSVCRT_LOCALE)
+        static _locale_t locale = _create_locale(LC_ALL, "C");
+        if (locale != nullptr) return _strtod_l(text, parsedEnd, locale);
+#endif
+        return strtodWithLocaleDecimalPoint(text, parsedEnd);
+    }
+}
+
+_parseStatus CsvFieldParser::parseInt(const char* begin, const char* end,
+        int& value) {
+    return parseInteger(begin, end, value);
+}
+
+_parseStatus CsvFieldParser::parseInt64(const char* begin, const char* end,
+        long long& value) {
+    return parseInteger(begin, end, value);
+}
+
+_parseStatus CsvFieldParser::parseDouble(const char* begin, const char* end,
+        double& value) {
+    const char* current = begin;
+    bool negative = false;
+    if (current < end && (*current == '-' || *current == '+')) {
+        negative = *current == '-';
+        ++current;
+    }
+
+    uint64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+    for (; current < end && isDigit(*current); ++current) {
+        mantissa = mantissa * 10 + (*current - '0');
+        if (mantissa != 0) ++mantissaDigits;
+        anyDigit = true;
+    }
+    if (current < end && *current == '.') {
+        for (++current; current < end && isDigit(*current); ++current) {
+            mantissa = mantissa * 10 + (*current - '0');
+            if (mantissa != 0) ++mantissaDigits;
+            --exponent;
+            anyDigit = true;
+        }
+    }
+    if (anyDigit && current < end && (*current == 'e' || *current == 'E')) {
+        bool negativeExponent = false;
+        if (++current < end && (*current == '-' || *current == '+')) {
+            negativeExponent = *current == '-';
+            ++current;
+        }
+        const char* exponentDigits = current;
+        int writtenExponent = 0;
+        for (; current < end && isDigit(*current)
+                && writtenExponent < 10000; ++current) {
+            writtenExponent = writtenExponent * 10 + (*current - '0');
+        }
+        if (current == exponentDigits) {
+            return parseDoubleWithStrtod(begin, end, value);
+        }
+        exponent += negativeExponent ? -writtenExponent : writtenExponent;
+    }
+
+    // Clinger's fast path: both mantissa and power of ten are exact doubles,
+    // so a single multiplication or division is correctly rounded.
+    if (anyDigit && current == end && mantissaDigits <= _maxMantissaDigits
+            && mantissa <= _maxExactMantissa
+            && exponent >= -_maxExactPowerOfTen
+            && exponent <= _maxExactPowerOfTen) {
+        double parsedValue = (double) mantissa;
+        if (exponent < 0) parsedValue /= _exactPowersOfTen[-exponent];
+        else parsedValue *= _exactPowersOfTen[exponent];
+        value = negative ? -parsedValue : parsedValue;
+        return parse_ok;
+    }
+    // Long numbers, special values, whitespace and invalid text.
+    return parseDoubleWithStrtod(begin, end, value);
+}
+
+_parseStatus CsvFieldParser::parseDoubleWithStrtod(const char* begin,
+        const char* end, double& value) {
+    char buffer[_conversionBufferSize];
+    std::string longField;
+    char* text = buffer;
+    size_t length = end - begin;
+    if (length < (size_t) _conversionBufferSize) {
+        memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+    } else {
+        longField.assign(begin, end);
+        text = &longField[0];
+    }
+
+    char* parsedEnd;
+    errno = 0;
+    double parsedValue = strtodInCLocale(text, &parsedEnd);
+    if (parsedEnd == text) {
+        return parse_invalid_argument;
+    } else if (errno == ERANGE) {
+        return parse_out_of_range;
+    } else if (parsedEnd != text + length) {
+        return parse_type_not_correct;
+    }
+    value = parsedValue;
+    return parse_ok;
+}
+
+const char* CsvFieldParser::getStatusMessage(_parseStatus status) {
+    switch (status) {
+        case parse_invalid_argument:
+            return UnableToConvertFieldTypeException::_invalidArgumentMsg;
+        case parse_out_of_range:
+            return UnableToConvertFieldTypeException::_indexOutOfRangeMsg;
+        default:
+            return UnableToConvertFieldTypeException::_typeNotCorrectMsg;
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * File:   CsvFieldParser.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVFIELDPARSER_HPP
+#define CSVFIELDPARSER_HPP
+
+namespace csvh {
+
+    /**
+     * Enum to represent result of field conversion.
+     */
+    enum _parseStatus {
+        parse_ok,
+        parse_invalid_argument,
+        parse_out_of_range,
+        parse_type_not_correct
+    };
+
+    /**
+     * Class is used to convert field text to numbers and dates without
+     * exceptions and without heap allocation. Conversion does not depend
+     * on current locale, '.' is always the decimal point.
+     * Accepted text is the same as for std::stoi / std::stod: leading
+     * whitespace is skipped and the whole field has to be consumed.
+     */
+    class CsvFieldParser {
+    public:
+
+        /**
+         * Method is used to convert text to int.
+         *
+         * @param begin
+         * @param end
+         * @param value - set only when parse_ok is returned
+         * @return conversion status
+         */
+        static _parseStatus parseInt(const char* begin, const char* end,
+                int& value);
+
+        /**
+         * Method is used to convert text to 64-bit integer.
+         *
+         * @param begin
+         * @param end
+         * @param value - set only when parse_ok is returned
+         * @return conversion status
+         */
+        static _parseStatus parseInt64(const char* begin, const char* end,
+                long long& value);
+
+        /**
+         * Method is used to convert text to double. Short decimal numbers
+         * are converted exactly by a fast path, other ones by strtod.
+         *
+         * @param begin
+         * @param end
+         * @param value - set only when parse_ok is returned
+         * @return conversion status
+         */
+        static _parseStatus parseDouble(const char* begin, const char* end,
+                double& value);
+
+        /**
+         * Method returns description of failed conversion, used in
+         * UnableToConvertFieldTypeException messages.
+         *
+         * @param status
+         * @return message
+         */
+        static const char* getStatusMessage(_parseStatus status);
+
+    private:
+
+        /**
+         * Numbers and dates longer than that are converted from
+         * a heap allocated copy.
+         */
+        static const int _conversionBufferSize = 128;
+
+        static _parseStatus parseDoubleWithStrtod(const char* begin,
+                const char* end, double& value);
+    };
+}
+
+#endif /* CSVFIELDPARSER_HPP */
@@ -0,0 +1,191 @@
+/*
+ * File:   CsvFieldTape.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVFIELDTAPE_HPP
+#define CSVFIELDTAPE_HPP
+
+#include <string>
+#include <vector>
+#include "CsvStringSlice.hpp"
+
+namespace csvh {
+
+    /**
+     * Position of a single field on the tape, relative to tape data.
+     */
+    struct CsvTapeField {
+        long long offset;
+        unsigned int length;
+        bool quoted;
+    };
+
+    /**
+     * Position of an entry line and index of its first field.
+     */
+    struct CsvTapeRow {
+        long long firstField;
+        long long lineOffset;
+        long long lineLength;
+    };
+
+    /**
+     * Fields of tokenized entries stored as (offset, length, quoted) triples
+     * pointing into the read buffer. Tape is cleared and refilled for every
+     * chunk, so its vectors are allocated once and fields are converted
+     * straight from the buffer without intermediate strings.
+     */
+    class CsvFieldTape {
+    public:
+
+        CsvFieldTape() : _data(nullptr), _firstRow(0) {
+        }
+
+        /**
+         * Method is used to start new tape over given data.
+         * Allocated capacity is kept.
+         *
+         * @param data - buffer referenced by fields
+         */
+        void clear(const char* data) {
+            _data = data;
+            _ownedData.clear();
+            _fields.clear();
+            _rows.clear();
+            _firstRow = 0;
+        }
+
+        /**
+         * Method is used to start new entry. Fields added afterwards
+         * belong to this entry.
+         *
+         * @param line - beginning of entry line inside tape data
+         */
+        void beginRow(const char* line) {
+            CsvTapeRow row = {(long long) _fields.size(), line - getData(), 0};
+            _rows.push_back(row);
+        }
+
+        /**
+         * Method is used to set end of the last entry line.
+         *
+         * @param lineEnd - position behind the last byte of the line
+         */
+        void endRow(const char* lineEnd) {
+            _rows.back().lineLength = lineEnd - getData() - _rows.back().lineOffset;
+        }
+
+        /**
+         * Method is used to remove the last entry with its fields,
+         * e.g. line cut at the end of a chunk.
+         */
+        void removeLastRow() {
+            _fields.resize(_rows.back().firstField);
+            _rows.pop_back();
+        }
+
+        /**
+         * Method is used to add field to the last entry.
+         *
+         * @param field - slice inside tape data
+         * @param quoted - field starts with quotation mark
+         */
+        void addField(const char* field, long long length, bool quoted) {
+            CsvTapeField tapeField = {field - getData(),
+                (unsigned int) length, quoted};
+            _fields.push_back(tapeField);
+        }
+
+        /**
+         * Method is used to add entry whose text is not kept in the read
+         * buffer, e.g. built from JSON. Text is copied into the tape,
+         * which must be cleared with nullptr data.
+         *
+         * @param line
+         * @param fields
+         */
+        void addOwnedRow(const CsvStringSlice& line,
+                const std::vector<std::string>& fields) {
+            CsvTapeRow row = {(long long) _fields.size(),
+                (long long) _ownedData.size(), (long long) line.size()};
+            _rows.push_back(row);
+            _ownedData.append(line.data(), line.size());
+            for (const std::string& field : fields) {
+                CsvTapeField tapeField = {(long long) _ownedData.size(),
+                    (unsigned int) field.size(),
+                    !field.empty() && field[0] == '"'};
+                _fields.push_back(tapeField);
+                _ownedData += field;
+            }
+        }
+
+        /**
+         * Method is used to skip first entry of the tape, e.g. header.
+         */
+        void dropFirstRow() {
+            if (_firstRow < (long long) _rows.size()) ++_firstRow;
+        }
+
+        long long getAmountOfRows() const {
+            return _rows.size() - _firstRow;
+        }
+
+        long long getAmountOfFields(long long row) const {
+            long long rowId = _firstRow + row;
+            long long fieldsEnd = rowId + 1 < (long long) _rows.size() ?
+                    _rows[rowId + 1].firstField : (long long) _fields.size();
+            return fieldsEnd - _rows[rowId].firstField;
+        }
+
+        const CsvTapeField& getTapeField(long long row, int column) const {
+            return _fields[_rows[_firstRow + row].firstField + column];
+        }
+
+        CsvStringSlice getField(long long row, int column) const {
+            const CsvTapeField& field = getTapeField(row, column);
+            return CsvStringSlice(getData() + field.offset, field.length);
+        }
+
+        /**
+         * Method returns bytes allocated by the tape.
+         *
+         * @return memory usage
+         */
+        long long getMemoryUsage() const {
+            return _fields.capacity() * sizeof (CsvTapeField)
+                    + _rows.capacity() * sizeof (CsvTapeRow)
+                    + _ownedData.capacity();
+        }
+
+        /**
+         * Method returns offset of the entry line from the beginning
+         * of tape data.
+         *
+         * @param row
+         * @return offset in bytes
+         */
+        long long getLineOffset(long long row) const {
+            return _rows[_firstRow + row].lineOffset;
+        }
+
+        CsvStringSlice getLine(long long row) const {
+            const CsvTapeRow& tapeRow = _rows[_firstRow + row];
+            return CsvStringSlice(getData() + tapeRow.lineOffset,
+                    tapeRow.lineLength);
+        }
+
+    private:
+        const char* _data;
+        std::string _ownedData;
+        std::vector<CsvTapeField> _fields;
+        std::vector<CsvTapeRow> _rows;
+        long long _firstRow;
+
+        const char* getData() const {
+            return _data != nullptr ? _data : _ownedData.data();
+        }
+    };
+}
+
+#endif /* CSVFIELDTAPE_HPP */
@@ -12,6 +12,11 @@
 #include <fstream>
 #include <limits>
 #include <regex>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <exception>
+#include <memory>
 
 using namespace csvh;
 extern std::ostream cerr;
@@ -22,7 +27,50 @@ CsvHandler::CsvHandler(const std::string& csvFileName,
         char delimiter,
         _headerMode headerMode) {
     _inFileName = csvFileName;
+    // Source is owned by the handler only when construction succeeds,
+    // destructor is not called for a throwing constructor.
+    std::unique_ptr<CsvDataSource> dataSource(new CsvFileSource(csvFileName));
+    _compressionFormat compression =
+            CsvDecompressingSource::detectCompression(csvFileName);
+    if (compression != no_compression) {
+        dataSource.reset(new CsvDecompressingSource(dataSource.release(),
+                compression));
+        if (loadDataMode == load_mmap) loadDataMode = load_whole_file;
+    }
+    _dataSource = dataSource.get();
+    propertiesInitializer(loadDataMode, fileFormat, delimiter, headerMode);
+    classInitializer();
+    dataSource.release();
+}
+
+CsvHandler::CsvHandler(CsvDataSource* dataSource,
+        _loadDataMode loadDataMode,
+        _fileFormat fileFormat,
+        char delimiter,
+        _headerMode headerMode) {
+    std::unique_ptr<CsvDataSource> ownedSource(dataSource);
+    _dataSource = dataSource;
+    if (loadDataMode == load_mmap) loadDataMode = load_whole_file;
+    propertiesInitializer(loadDataMode, fileFormat, delimiter, headerMode);
+    classInitializer();
+    ownedSource.release();
+}
+
+CsvHandler::CsvHandler(std::istream& inStream,
+        _loadDataMode loadDataMode,
+        _fileFormat fileFormat,
+        char delimiter,
+        _headerMode headerMode)
+: CsvHandler(new CsvStreamSource(inStream), loadDataMode, fileFormat,
+delimiter, headerMode) {
+}
+
+void CsvHandler::propertiesInitializer(_loadDataMode loadDataMode,
+        _fileFormat fileFormat,
+        char delimiter,
+        _headerMode headerMode) {
     _csvDelimiter = delimiter;
+    _scanner = CsvStructuralScanner(delimiter);
 
     _inFileFormatFlag = fileFormat;
     _headerModeFlag = headerMode;
@@ -30,47 +78,168 @@ CsvHandler::CsvHandler(const std::string& csvFileName,
 
     _entriesInCurrentChunk = 0;
     _inFileReadLastPosition = 0;
+    _chunkByteOffset = 0;
+    _linesRead = 0;
+    _chunkFirstLine = 1;
+    _rejectSink = &_defaultRejectLog;
     _absoluteBeginningIndex = 0;
     _absoluteEndingIndex = 0;
     _CRLF = false;
-    classInitializer();
+    _mappedFile = nullptr;
+    _chunkReader = nullptr;
+    _readAheadFlag = false;
+    _lazyParsingFlag = false;
+    _dictionaryEncodingFlag = true;
+    _integerNarrowingFlag = true;
+    _lazyErrorHandlingMode = stop_on_error;
+    _chunkSizingModeFlag = fixed_chunk_size;
+    _chunkSizingLimit = 0;
+    _memoryLimit = 0;
+    _chunkStorageMemory = 0;
+    _probeEndOfData = false;
+    _parserThreads = 1;
+    _elementArenas.resize(1);
+    _compactionThreshold = 0.25;
+    _typeSampleRows = _memorySampleRows;
+    _typeSampleModeFlag = sample_first_rows;
+    _dateFormat = CsvDateFormat(_defaultDTFormat);
+}
+
+CsvHandler::CsvHandler(const std::string& csvFileName,
+        _chunkSizingMode chunkSizingMode,
+        long long chunkSizingLimit,
+        _fileFormat fileFormat,
+        char delimiter,
+        _headerMode headerMode)
+: CsvHandler(csvFileName, load_in_chunks, fileFormat, delimiter, headerMode) {
+    _chunkSizingModeFlag = chunkSizingMode;
+    _chunkSizingLimit = chunkSizingLimit;
 }
 
 void CsvHandler::classInitializer() {
     _dataTypesMap.insert(std::make_pair(_tDouble, type_double));
     _dataTypesMap.insert(std::make_pair(_tInt, type_int));
+    _dataTypesMap.insert(std::make_pair(_tInt64, type_int64));
     _dataTypesMap.insert(std::make_pair(_tString, type_string));
     _dataTypesMap.insert(std::make_pair(_tDate, type_date));
 
-    _inFileLineEnding = determineLineEnding();
-    _inFileStreamSize = fetchFileStreamSize();
+    probeInputFile();
 
     if (_loadDataModeFlag == load_in_chunks) {
         _eofFlag = false;
-        if (_readBufferSize > _inFileStreamSize)
-            throw UnableToReadFileInChunks(_inFileStreamSize);
+        if (_inFileStreamSize != -1) {
+            _readBufferSize = std::min(_readBufferSize, _inFileStreamSize);
+        }
         _chunksCount = 0;
     } else {
         _eofFlag = true;
-        _readBufferSize = _inFileStreamSize;
+        _readBufferSize = _inFileStreamSize != -1 ?
+                _inFileStreamSize : CsvChunkReader::_wholeSource;
         _chunksCount = 1;
     }
 }
 
+void CsvHandler::probeInputFile() {
+    _inFileStreamSize = fetchFileStreamSize();
+    _probeBuffer.clear();
+    _inFileLineEnding = determineLineEnding();
+
+    if (_inFileFormatFlag == CSV && _headerModeFlag == include_header) {
+        csv_entrySlices headerLine = fetchProbeLines(1);
+        if (!headerLine.empty()) {
+            csv_entrySlices headerSlices;
+            splitEntryByDelimiter(headerLine.front(), headerSlices, _csvDelimiter);
+            _inFileHeader.clear();
+            for (const CsvStringSlice& caption : headerSlices) {
+                _inFileHeader.emplace_back(caption.toString());
+            }
+            _sourceFileHeader = _inFileHeader;
+        }
+    }
+}
+
+bool CsvHandler::extendProbeBuffer() {
+    // Once reading started, probed bytes are owned by the chunk reader.
+    if (_probeEndOfData || _chunkReader != nullptr) return false;
+
+    long long probeSize = _probeBuffer.size();
+    _probeBuffer.resize(probeSize + _probeReadSize);
+    long long bytesRead = _dataSource->read(&_probeBuffer[probeSize],
+            _probeReadSize);
+    _probeBuffer.resize(probeSize + bytesRead);
+    _probeEndOfData = bytesRead == 0;
+    return bytesRead > 0;
+}
+
+csv_entrySlices CsvHandler::fetchProbeLines(unsigned int amountOfLines) {
+    csv_entrySlices lines;
+    bool endOfProbe = false;
+
+    while (true) {
+        lines.clear();
+        const char* probe = _probeBuffer.data();
+        const char* probeEnd = probe + _probeBuffer.size();
+        const char* lineBegin = probe;
+        CsvLineCursor cursor = _scanner.findLineEndings(probe, probeEnd);
+        for (const char* current = _scanner.nextLineEnding(cursor);
+                current < probeEnd && lines.size() < amountOfLines;
+                current = _scanner.nextLineEnding(cursor)) {
+            if (current > lineBegin) {
+                lines.emplace_back(lineBegin, current - lineBegin);
+            }
+            lineBegin = current + 1;
+        }
+        if (lines.size() == amountOfLines) break;
+
+        if (endOfProbe) {
+            if (lineBegin < probeEnd) {
+                lines.emplace_back(lineBegin, probeEnd - lineBegin);
+            }
+            break;
+        }
+        // Buffer can be reallocated even if nothing was read,
+        // so lines are found again in the final buffer.
+        endOfProbe = !extendProbeBuffer();
+    }
+    return lines;
+}
+
 CsvHandler::~CsvHandler() {
     clearStorage();
     clearHeader();
     clearDataTypes();
+    delete _mappedFile;
+    delete _chunkReader;
+    delete _dataSource;
 }
 
 void CsvHandler::clearStorage() {
-    while (!_sourceFileVector.empty()) {
-        while (!_sourceFileVector.back().empty()) {
-            delete _sourceFileVector.back().back();
-            _sourceFileVector.back().pop_back();
+    // Arena elements of other types hold no memory of their own,
+    // so only strings are destroyed before arenas are reset.
+    for (unsigned int columnId = 0; columnId < _sourceFileVector.size(); ++columnId) {
+        if (_dataTypesMap.at(_sourceFileColumnTypes[columnId]) != type_string) continue;
+        for (CsvEntryElement* field : _sourceFileVector[columnId]) {
+            if (_heapElements.empty() || _heapElements.count(field) == 0) {
+                field->~CsvEntryElement();
+            }
         }
-        _sourceFileVector.pop_back();
     }
+    for (CsvEntryElement* field : _heapElements) {
+        delete field;
+    }
+    _heapElements.clear();
+    for (CsvEntryElement* field : _dictionaryFieldViews) {
+        field->~CsvEntryElement();
+    }
+    _dictionaryFieldViews.clear();
+    _sourceFileVector.clear();
+    for (CsvArena& arena : _elementArenas) {
+        arena.reset();
+    }
+    // Column stores are kept, arrays not freed by materializeAllColumns
+    // are reused by the next chunk.
+    _columnStates.clear();
+    _removedRows.clear();
 }
 
 void CsvHandler::clearHeader() {
@@ -85,70 +254,28 @@ void CsvHandler::clearDataTypes() {
     }
 }
 
-namespace csvh {
-
-	template<>
-	int CsvHandler::convertString<int>(const std::string & toBeParsed, long long entryIndex) {
-		std::stringstream msg;
-		msg << "Row " << entryIndex << _colon << _space;
-		msg << UnableToConvertFieldTypeException::_convertIntErrorMsg << toBeParsed;
-		try {
-			int parsedValue = std::stoi(toBeParsed, &sizeType);
-			if (sizeType == toBeParsed.size()) {
-				return parsedValue;
-			}
-		} catch (const std::invalid_argument &exc) {
-			msg << UnableToConvertFieldTypeException::_invalidArgumentMsg;
-			throw UnableToConvertFieldTypeException(msg.str());
-		} catch (const std::out_of_range &exc) {
-			msg << UnableToConvertFieldTypeException::_indexOutOfRangeMsg;
-			throw UnableToConvertFieldTypeException(msg.str());
-		}
-		msg << UnableToConvertFieldTypeException::_typeNotCorrectMsg;
-		throw UnableToConvertFieldTypeException(msg.str());
-	}
-
-	template<>
-	double CsvHandler::convertString<double>(const std::string & toBeParsed, long long entryIndex) {
-		std::stringstream msg;
-		msg << "Row " << entryIndex << _colon << _space;
-		msg << UnableToConvertFieldTypeException::_convertDoubleErrorMsg
-				<< toBeParsed;
-		try {
-			double parsedValue = std::stod(toBeParsed, &sizeType);
-			if (sizeType == toBeParsed.size()) {
-				return parsedValue;
-			}
-		} catch (const std::invalid_argument &exc) {
-			msg << UnableToConvertFieldTypeException::_invalidArgumentMsg;
-			throw UnableToConvertFieldTypeException(msg.str());
-		} catch (const std::out_of_range &exc) {
-			msg << UnableToConvertFieldTypeException::_indexOutOfRangeMsg;
-			throw UnableToConvertFieldTypeException(msg.str());
-		}
-		msg << UnableToConvertFieldTypeException::_typeNotCorrectMsg;
-		throw UnableToConvertFieldTypeException(msg.str());
-	}
-
-	template<>
-	std::time_t CsvHandler::convertString<std::time_t>(const std::string & toBeParsed,
-													   long long entryIndex) {
-		std::tm parsedValue;
-		std::istringstream dateStream{toBeParsed};
-
-		dateStream >> std::get_time(&parsedValue, _defaultDTFormat);
-		std::time_t dt = std::mktime(&parsedValue);
-		if (dt != -1) {
-			return dt;
-		}
-		throw UnableToConvertFieldTypeException(
-				UnableToConvertFieldTypeException::_convertDateErrorMsg);
-	}
-}
-
-bool CsvHandler::loadHeader(std::string & line) {
+void CsvHandler::throwConversionError(_dataTypes type, _parseStatus status,
+        const CsvStringSlice& field, long long entryIndex) {
+    if (type == type_date) {
+        throw UnableToConvertFieldTypeException(
+                UnableToConvertFieldTypeException::_convertDateErrorMsg);
+    }
+    std::stringstream msg;
+    msg << "Row " << entryIndex << _colon << _space;
+    msg << (type != type_double ? UnableToConvertFieldTypeException::_convertIntErrorMsg
+            : UnableToConvertFieldTypeException::_convertDoubleErrorMsg);
+    msg << field << CsvFieldParser::getStatusMessage(status);
+    throw UnableToConvertFieldTypeException(msg.str());
+}
+
+bool CsvHandler::loadHeader(const CsvStringSlice & line) {
+    csv_entrySlices splittedSlices;
+    splitEntryByDelimiter(line, splittedSlices, _csvDelimiter);
     std::vector<std::string> splittedLine;
-    splitEntryByDelimiter(line, splittedLine, _csvDelimiter);
+    splittedLine.reserve(splittedSlices.size());
+    for (const CsvStringSlice& field : splittedSlices) {
+        splittedLine.emplace_back(field.toString());
+    }
     return loadHeader(splittedLine);
 }
 
@@ -166,29 +293,129 @@ bool CsvHandler::loadHeader(std::vector<std::string> entryLine) {
 }
 
 void CsvHandler::autoDetectTypesForColumns() {
-    std::string line;
-    csv_entryLine firstLineElements;
-    std::ifstream csvFileStrem(_inFileName);
+    unsigned int firstEntryLine = 0;
 
     if (_headerModeFlag == include_header || _headerModeFlag == skip_header) {
-        std::getline(csvFileStrem, line, _inFileLineEnding);
+        firstEntryLine = 1;
+    }
+
+    long long sampleRows = std::max(_typeSampleRows, 1LL);
+    bool spreadSample = _typeSampleModeFlag == sample_spread
+            && _inFileFormatFlag == CSV && !_inFileName.empty()
+            && _inFileStreamSize > 0
+            && CsvDecompressingSource::detectCompression(_inFileName)
+            == no_compression;
+    long long linesPerWindow = spreadSample ?
+            (sampleRows + _typeSampleWindows - 1) / _typeSampleWindows :
+            sampleRows;
+
+    csv_entrySlices lines = fetchProbeLines(firstEntryLine + linesPerWindow);
+    if (lines.size() <= firstEntryLine) {
+        _inFileColumnTypes = _sourceFileColumnTypes;
+        return;
+    }
+    lines.erase(lines.begin(), lines.begin() + firstEntryLine);
+
+    std::string sampleText;
+    if (spreadSample) fetchSpreadSampleLines(linesPerWindow, sampleText, lines);
+
+    // Lines with different amount of fields, e.g. cut in the middle of
+    // a quoted field by spread sampling, are not taken into account.
+    std::vector<csv_entrySlices> sample(1);
+    splitEntryByDelimiter(lines.front(), sample.front(), _csvDelimiter);
+    for (unsigned int lineId = 1; lineId < lines.size(); ++lineId) {
+        sample.emplace_back();
+        splitEntryByDelimiter(lines[lineId], sample.back(), _csvDelimiter);
+        if (sample.back().size() != sample.front().size()) sample.pop_back();
+    }
+
+    long long amountOfColumns = sample.front().size();
+    std::vector<_dataTypes> columnTypes(amountOfColumns, type_string);
+    unsigned int threads = countParserThreads(amountOfColumns * sample.size(),
+            _minEntriesPerParserThread);
+    threads = std::min((long long) threads, amountOfColumns);
+    runInParallel(threads, amountOfColumns,
+            [this, &sample, &columnTypes](unsigned int, long long columnBegin,
+            long long columnEnd) {
+                for (long long col = columnBegin; col < columnEnd; ++col) {
+                    bool typeKnown = false;
+                    _dataTypes columnType = type_string;
+                    for (const csv_entrySlices& fields : sample) {
+                        // Empty fields are nulls and fit any type.
+                        if (fields[col].empty()) continue;
+                        _dataTypes fieldType = determineColumnType(fields[col]);
+                        columnType = typeKnown ?
+                                widenColumnType(columnType, fieldType) : fieldType;
+                        typeKnown = true;
+                        if (columnType == type_string) break;
+                    }
+                    columnTypes[col] = columnType;
+                }
+            });
+
+    _sourceFileColumnTypes.reserve(amountOfColumns);
+    for (_dataTypes columnType : columnTypes) {
+        _sourceFileColumnTypes.emplace_back(getDataTypeAsString(columnType));
+    }
+    _inFileColumnTypes = _sourceFileColumnTypes;
+}
+
+void CsvHandler::fetchSpreadSampleLines(long long linesPerWindow,
+        std::string& sampleText, csv_entrySlices& sampleLines) {
+    std::ifstream sampledFile(_inFileName, std::ios::binary);
+    std::string window;
+
+    for (unsigned int windowId = 1; windowId < _typeSampleWindows; ++windowId) {
+        long long offset = _inFileStreamSize * windowId / _typeSampleWindows;
+        window.resize(_probeReadSize);
+        sampledFile.clear();
+        sampledFile.seekg(offset);
+        sampledFile.read(&window[0], _probeReadSize);
+        window.resize(sampledFile.gcount());
+
+        // First line of the window is usually incomplete. CRLF lines are
+        // found by LF, CR is stripped below.
+        size_t lineBegin = window.find(_inFileLineEnding);
+        long long amountOfLines = 0;
+        while (lineBegin != std::string::npos && amountOfLines < linesPerWindow) {
+            size_t lineEnd = window.find(_inFileLineEnding, lineBegin + 1);
+            if (lineEnd == std::string::npos) break;
+            size_t lineLength = lineEnd - lineBegin - 1;
+            if (lineLength > 0 && window[lineEnd - 1] == _CR) --lineLength;
+            if (lineLength > 0) {
+                sampleText.append(window, lineBegin + 1, lineLength);
+                sampleText += '\n';
+                ++amountOfLines;
+            }
+            lineBegin = lineEnd;
+        }
     }
 
-    if (std::getline(csvFileStrem, line, _inFileLineEnding)) {
-        splitEntryByDelimiter(line, firstLineElements, _csvDelimiter);
+    const char* lineBegin = sampleText.data();
+    for (const char* current = lineBegin;
+            current < sampleText.data() + sampleText.size(); ++current) {
+        if (*current == '\n') {
+            sampleLines.emplace_back(lineBegin, current - lineBegin);
+            lineBegin = current + 1;
+        }
     }
-    csvFileStrem.close();
-    autoDetectTypesForColumns(firstLineElements);
 }
 
 void CsvHandler::autoDetectTypesForColumns(csv_entryLine & firstLineElements) {
     _sourceFileColumnTypes.reserve(firstLineElements.size());
     for (std::string entryElement : firstLineElements) {
-        _sourceFileColumnTypes.emplace_back(determineColumnType(entryElement));
+        _sourceFileColumnTypes.emplace_back(
+                getDataTypeAsString(determineColumnType(entryElement)));
     }
     _inFileColumnTypes = _sourceFileColumnTypes;
 }
 
+void CsvHandler::setTypeDetectionSample(long long sampleRows,
+        _typeSampleMode sampleMode) {
+    _typeSampleRows = sampleRows;
+    _typeSampleModeFlag = sampleMode;
+}
+
 void CsvHandler::provideTypesForColumns(unsigned int amountOfColumns, _dataTypes dataTypes...) {
     va_list types;
     va_start(types, dataTypes);
@@ -273,175 +500,1130 @@ UserDefinedTypesValidationResult CsvHandler::validateTypesForColumns(
 }
 
 void CsvHandler::initializeStorage() {
-    _sourceFileVector.reserve(_sourceFileColumnTypes.size());
-    csv_entryLine::iterator typeIt = _sourceFileColumnTypes.begin();
-
-    for (unsigned int columnId = 0; columnId < _sourceFileColumnTypes.size(); ++columnId) {
-        _dataTypes dataColumnType = _dataTypesMap[*typeIt];
+    // Columns are converted into _columnStores by parseColumn, element
+    // objects are created only when column is accessed by element API.
+    _sourceFileVector.resize(_sourceFileColumnTypes.size());
+    _columnStores.resize(_sourceFileColumnTypes.size());
+    _columnStates.assign(_sourceFileColumnTypes.size(), column_on_tape);
+}
+
+unsigned int CsvHandler::countParserThreads(long long amountOfWork,
+        long long minWorkPerThread) {
+    long long threads = std::min((long long) _parserThreads,
+            amountOfWork / minWorkPerThread);
+    return std::max(threads, 1LL);
+}
+
+void CsvHandler::runInParallel(unsigned int threads, long long amountOfWork,
+        const csv_rangeTask& task) {
+    if (threads <= 1) {
+        task(0, 0, amountOfWork);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    workers.reserve(threads);
+    for (unsigned int rangeId = 0; rangeId < threads; ++rangeId) {
+        long long rangeBegin = amountOfWork * rangeId / threads;
+        long long rangeEnd = amountOfWork * (rangeId + 1) / threads;
+        workers.emplace_back([&task, &errors, rangeId, rangeBegin, rangeEnd]() {
+            try {
+                task(rangeId, rangeBegin, rangeEnd);
+            } catch (...) {
+                errors[rangeId] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    // Error of the first range is the one serial parsing would report.
+    for (std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
 
-        switch (dataColumnType) {
-            case type_double:
-                _sourceFileVector.emplace_back(
-                        initializeEntriesForColumn<csv_doubleField>());
-                break;
-            case type_int:
-                _sourceFileVector.emplace_back(
-                        initializeEntriesForColumn<csv_intField>());
-                break;
-            default:
-                _sourceFileVector.emplace_back(
-                        initializeEntriesForColumn<csv_stringField>());
-                break;
-        }
-        ++typeIt;
+void CsvHandler::setParserThreads(unsigned int threads) {
+    _parserThreads = threads != 0 ? threads
+            : std::max(std::thread::hardware_concurrency(), 1U);
+    if (_elementArenas.size() < _parserThreads) {
+        _elementArenas.resize(_parserThreads);
     }
 }
 
-template<class EntryType >
-std::vector<CsvEntryElement*> CsvHandler::initializeEntriesForColumn() {
+void CsvHandler::setDateFormat(const std::string& dateFormat) {
+    _dateFormat = CsvDateFormat(dateFormat);
+}
+
+std::vector<CsvEntryElement*> CsvHandler::initializeEntriesForColumn(
+        _dataTypes type) {
     std::vector<CsvEntryElement*> columnEntriesVector;
     columnEntriesVector.reserve(_entriesInCurrentChunk);
 
     for (int entryId = 0; entryId < _entriesInCurrentChunk; ++entryId) {
-        columnEntriesVector.emplace_back(new EntryType());
+        columnEntriesVector.emplace_back(newEntryElement(type));
     }
     return columnEntriesVector;
 }
 
+CsvEntryElement* CsvHandler::newEntryElement(_dataTypes type,
+        unsigned int arenaId) {
+    CsvArena& arena = _elementArenas[arenaId];
+    switch (type) {
+        case type_double:
+            return arena.create<csv_doubleField>();
+        case type_int:
+            return arena.create<csv_intField>();
+        case type_int64:
+            return arena.create<csv_int64Field>();
+        case type_date:
+            return arena.create<csv_dateField>(&_dateFormat);
+        default:
+            return arena.create<csv_stringField>();
+    }
+}
+
+void CsvHandler::deleteEntryElement(CsvEntryElement* field) {
+    auto heapElement = _heapElements.find(field);
+    if (heapElement == _heapElements.end()) {
+        // Memory is released when arena is reset.
+        field->~CsvEntryElement();
+        return;
+    }
+    _heapElements.erase(heapElement);
+    delete field;
+}
+
 char CsvHandler::determineLineEnding() {
-    char currentChar;
-    std::ifstream file(_inFileName, std::ios::binary);
-    while (file >> std::noskipws >> currentChar)
-        if (currentChar == _CR) {
-            file >> std::noskipws >> currentChar;
-            if (currentChar == _LF) {
+    for (unsigned long pos = 0; ; ++pos) {
+        if (pos >= _probeBuffer.size() && !extendProbeBuffer()) {
+            return _LF;
+        }
+        if (_probeBuffer[pos] == _CR) {
+            if (pos + 1 >= _probeBuffer.size() && !extendProbeBuffer()) {
+                return _CR;
+            }
+            if (_probeBuffer[pos + 1] == _LF) {
                 _CRLF = true;
                 return _LF;
             }
-            else return _CR;
-        } else if (currentChar == _LF) {
+            return _CR;
+        } else if (_probeBuffer[pos] == _LF) {
             return _LF;
         }
-    return _LF;
-}
-
-int CsvHandler::fetchNumberOfCSVEntries() {
-    int counter = 0;
-    std::ifstream csvFileStrem(_inFileName);
-    std::string line;
-
-    while (std::getline(csvFileStrem, line, _inFileLineEnding)) {
-        if (line.size()) {
-            ++counter;
-        }
     }
-    csvFileStrem.close();
-    return counter;
 }
 
 long long CsvHandler::fetchFileStreamSize() {
-    std::ifstream fstream(_inFileName.c_str());
-    if(!fstream.good()) {
-        throw UnableToOpenFileException();
-    }
-
-    fstream.ignore(std::numeric_limits<std::streamsize>::max());
-    std::streamsize length = fstream.gcount();
-    fstream.clear();
-    return length;
+    return _dataSource->size();
 }
 
 long long CsvHandler::getAmountOfEntries() {
-    return _entriesInCurrentChunk;
+    return _entriesInCurrentChunk - _removedRows.countRemoved();
 }
 
 int CsvHandler::getAmountOfColumns() {
     return _sourceFileColumnTypes.size();
 }
 
-std::string CsvHandler::determineColumnType(const std::string & value) {
-    if (value.length() > 1 && value.at(0) == _quotationMark)
-        return _tString;
+_dataTypes CsvHandler::determineColumnType(const CsvStringSlice & value) {
+    if (value.size() > 1 && value[0] == _quotationMark)
+        return type_string;
 
-    try {
-        convertString<int>(value, -1);
-        return _tInt;
-    } catch (const UnableToConvertFieldTypeException &exc) {
-        try {
-            convertString<double>(value, -1);
-            return _tDouble;
-        } catch (const UnableToConvertFieldTypeException &exc) {
-            try {
-                convertString<std::time_t>(value, -1);
-                return _tDate;
-            } catch (const UnableToConvertFieldTypeException &exc) {
-                return _tString;
-            }
-        }
+    int intValue;
+    long long int64Value;
+    double doubleValue;
+    std::time_t dateValue;
+    if (CsvFieldParser::parseInt(value.begin(), value.end(), intValue) == parse_ok) {
+        return type_int;
+    } else if (CsvFieldParser::parseInt64(value.begin(), value.end(),
+            int64Value) == parse_ok) {
+        return type_int64;
+    } else if (CsvFieldParser::parseDouble(value.begin(), value.end(),
+            doubleValue) == parse_ok) {
+        return type_double;
+    } else if (_dateFormat.parse(value.begin(), value.end(),
+            dateValue) == parse_ok) {
+        return type_date;
     }
-    return _tString;
+    return type_string;
+}
+
+_dataTypes CsvHandler::widenColumnType(_dataTypes columnType,
+        _dataTypes fieldType) {
+    if (columnType == fieldType) return columnType;
+    bool columnInteger = columnType == type_int || columnType == type_int64;
+    bool fieldInteger = fieldType == type_int || fieldType == type_int64;
+    if (columnInteger && fieldInteger) {
+        return type_int64;
+    } else if ((columnInteger || columnType == type_double)
+            && (fieldInteger || fieldType == type_double)) {
+        return type_double;
+    }
+    return type_string;
 }
 
 bool CsvHandler::loadEntries(_errorHandlingMode errorHandlingMode) {
     if (_loadDataModeFlag == load_in_chunks) {
         if (_eofFlag) {
             _inFileReadLastPosition = _absoluteEndingIndex = _chunksCount = 0;
+            _linesRead = 0;
             return false;
         }
-    } else _inFileReadLastPosition = _absoluteEndingIndex = 0;
+    } else {
+        _inFileReadLastPosition = _absoluteEndingIndex = 0;
+        _linesRead = 0;
+        _buffLeftovers.clear();
+    }
 
     clearStorage();
 
-    if (_loadDataModeFlag == load_in_chunks
-            && (_chunksCount + 1) * _readBufferSize > _inFileStreamSize) {
-        _readBufferSize = _inFileStreamSize - (_readBufferSize * _chunksCount);
-        _eofFlag = true;
+    if ((_loadDataModeFlag == load_whole_file || _loadDataModeFlag == load_mmap)
+            && _memoryLimit > 0 && _inFileStreamSize > _memoryLimit) {
+        throw MemoryLimitExceededException(_inFileStreamSize, _memoryLimit);
+    }
+
+    if (_loadDataModeFlag == load_mmap) {
+        if (_mappedFile == nullptr) _mappedFile = new CsvMappedFile(_inFileName);
+        _chunkByteOffset = 0;
+        if (_inFileFormatFlag == CSV) {
+            loadEntries_CSV(_mappedFile->data(), _mappedFile->size(),
+                    errorHandlingMode);
+        } else if (_inFileFormatFlag == JSON) {
+            loadEntries_JSON(_mappedFile->data(), _mappedFile->size(),
+                    errorHandlingMode);
+        }
+        if (_rejectSink != nullptr) _rejectSink->finish();
+        return true;
+    }
+
+    if (_chunkReader == nullptr) {
+        if (_inFileFormatFlag == CSV && _sourceFileColumnTypes.empty()) {
+            autoDetectTypesForColumns();
+        }
+        if (isReadBufferSizeAdaptive()) {
+            estimateReadBufferSize();
+        }
+        // Probed bytes were already consumed from the source,
+        // so reader returns them first instead of seeking back.
+        _chunkReader = new CsvChunkReader(_dataSource, _probeBuffer,
+                _readBufferSize,
+                _readAheadFlag && _loadDataModeFlag == load_in_chunks);
+    } else if (_loadDataModeFlag == load_whole_file) {
+        _chunkReader->rewind();
+        _chunkReader->setChunkSize(_readBufferSize);
+    }
+
+    CsvChunk chunk = loadChunkOfFile(_stitchBuffer);
+    if (_loadDataModeFlag == load_in_chunks) {
+        _eofFlag = chunk.last;
+        ++_chunksCount;
+    }
+    if (_inFileFormatFlag == CSV) {
+        loadEntries_CSV(chunk.data, chunk.size, errorHandlingMode);
+    } else if (_inFileFormatFlag == JSON) {
+        loadEntries_JSON(chunk.data, chunk.size, errorHandlingMode);
+    }
+    if (isReadBufferSizeAdaptive()) {
+        adjustReadBufferSize(chunk.size);
+    }
+    if (_eofFlag && _rejectSink != nullptr) _rejectSink->finish();
+
+    return true;
+}
+
+long long CsvHandler::computeReadBufferSize(double bytesPerRow,
+        double memoryPerRow) {
+    double chunkSize = _readBufferSize;
+    bytesPerRow = std::max(bytesPerRow, 1.0);
+
+    if (_chunkSizingModeFlag == chunk_by_rows) {
+        chunkSize = _chunkSizingLimit * bytesPerRow;
+    } else if (_chunkSizingModeFlag == chunk_by_memory_budget) {
+        chunkSize = fitChunkSize(_chunkSizingLimit, bytesPerRow, memoryPerRow);
+    }
+    if (_memoryLimit > 0) {
+        chunkSize = std::min(chunkSize,
+                fitChunkSize(_memoryLimit * _memoryLimitFill, bytesPerRow,
+                memoryPerRow));
+    }
+    long long maxChunkSize = _inFileStreamSize != -1 ?
+            std::max(_inFileStreamSize, _minReadBufferSize) :
+            std::numeric_limits<long long>::max();
+    return std::min(std::max((long long) chunkSize, _minReadBufferSize),
+            maxChunkSize);
+}
+
+double CsvHandler::fitChunkSize(double budget, double bytesPerRow,
+        double memoryPerRow) {
+    // Budget has to hold read buffers (two with read-ahead), entry line
+    // slices and loaded fields for every byte of the chunk.
+    double buffers = _readAheadFlag ? 2.0 : 1.0;
+    double rowOverhead = memoryPerRow + sizeof (CsvStringSlice);
+    return budget / (buffers + rowOverhead / bytesPerRow);
+}
+
+bool CsvHandler::isReadBufferSizeAdaptive() {
+    return _loadDataModeFlag == load_in_chunks
+            && (_chunkSizingModeFlag != fixed_chunk_size || _memoryLimit > 0);
+}
+
+void CsvHandler::estimateReadBufferSize() {
+    if (_inFileFormatFlag == CSV && _sourceFileColumnTypes.empty()) {
+        autoDetectTypesForColumns();
+    }
+    applyColumnSelection();
+    csv_entrySlices lines = fetchProbeLines(_memorySampleRows + 1);
+    if (_headerModeFlag != no_header && !lines.empty()) {
+        lines.erase(lines.begin());
+    }
+
+    double bytesPerRow = 0.0;
+    double memoryPerRow = 0.0;
+    csv_entrySlices fields;
+    for (const CsvStringSlice& line : lines) {
+        bytesPerRow += line.size() + (_CRLF ? 2 : 1);
+        fields.clear();
+        splitEntryByDelimiter(line, fields, _csvDelimiter);
+        // All fields are tokenized onto the tape before conversion.
+        memoryPerRow += fields.size() * sizeof (CsvTapeField) + sizeof (CsvTapeRow);
+        // Only selected columns are stored.
+        for (unsigned int colID = 0; colID < _sourceFileColumnTypes.size(); ++colID) {
+            unsigned int fileColumn = getFileColumn(colID);
+            if (fileColumn >= fields.size()) continue;
+            memoryPerRow += estimateFieldMemory(
+                    _dataTypesMap[_sourceFileColumnTypes[colID]],
+                    fields[fileColumn].size());
+        }
+    }
+    if (!lines.empty()) {
+        bytesPerRow /= lines.size();
+        memoryPerRow /= lines.size();
+    }
+    _readBufferSize = computeReadBufferSize(bytesPerRow, memoryPerRow);
+}
+
+void CsvHandler::adjustReadBufferSize(long long chunkSize) {
+    if (_entriesInCurrentChunk > 0) {
+        double bytesPerRow = (double) chunkSize / _entriesInCurrentChunk;
+        double memoryPerRow =
+                (double) _chunkStorageMemory / _entriesInCurrentChunk;
+        _readBufferSize = computeReadBufferSize(bytesPerRow, memoryPerRow);
+        _chunkReader->setChunkSize(_readBufferSize);
+    }
+}
+
+long long CsvHandler::estimateFieldMemory(_dataTypes type,
+        long long fieldLength) {
+    switch (type) {
+        case type_int:
+            return sizeof (int);
+        case type_int64:
+            return sizeof (long long);
+        case type_double:
+            return sizeof (double);
+        case type_date:
+            return sizeof (std::time_t);
+        default:
+            return fieldLength + sizeof (long long);
+    }
+}
+
+long long CsvHandler::getElementSize(_dataTypes type) {
+    switch (type) {
+        case type_double:
+            return sizeof (csv_doubleField);
+        case type_int:
+            return sizeof (csv_intField);
+        case type_int64:
+            return sizeof (csv_int64Field);
+        case type_date:
+            return sizeof (csv_dateField);
+        default:
+            return sizeof (csv_stringField);
+    }
+}
+
+long long CsvHandler::estimateStringPayload(long long fieldLength) {
+    // Short strings are stored inside std::string object itself.
+    if (fieldLength >= (long long) std::string().capacity()) {
+        return fieldLength + 1 + _heapAllocationOverhead;
+    }
+    return 0;
+}
+
+CsvMemoryUsage CsvHandler::getMemoryUsage() {
+    CsvMemoryUsage usage;
+    long long sampleStep =
+            std::max(_entriesInCurrentChunk / _memorySampleRows, 1LL);
+    unsigned long amountOfColumns =
+            std::max(_sourceFileVector.size(), _columnStores.size());
+    for (unsigned int colID = 0; colID < amountOfColumns; ++colID) {
+        usage.columns.push_back(measureColumnMemory(colID, sampleStep));
+        usage.cellObjects += usage.columns.back().cellObjects;
+        usage.stringPayloads += usage.columns.back().stringPayloads;
+        usage.vectorCapacity += usage.columns.back().vectorCapacity;
+    }
+    for (const CsvArena& arena : _elementArenas) {
+        usage.cellObjects += arena.getMemoryUsage() - arena.getUsedMemory();
+    }
+
+    for (const CsvFieldTape& tape : _fieldTapes) {
+        usage.fieldTapes += tape.getMemoryUsage();
+    }
+    usage.fieldTapes += _fieldTapes.capacity() * sizeof (CsvFieldTape)
+            + _tapeFirstEntries.capacity() * sizeof (long long)
+            + _entryRows.capacity() * sizeof (long long)
+            + _removedRows.getMemoryUsage();
+
+    usage.metadata = measureStringsMemory(_inFileHeader)
+            + measureStringsMemory(_inFileColumnTypes)
+            + measureStringsMemory(_sourceFileHeader)
+            + measureStringsMemory(_sourceFileColumnTypes)
+            + _sourceFileVector.capacity() * sizeof (csv_blockedColumn)
+            + _columnStores.capacity() * sizeof (CsvColumnStore)
+            + _columnStates.capacity() * sizeof (_columnState)
+            + _selectedColumns.capacity() * sizeof (int);
+
+    if (_chunkReader != nullptr) {
+        usage.readBuffers += _chunkReader->getBuffersCapacity();
+    }
+    usage.readBuffers += _stitchBuffer.capacity() + _buffLeftovers.capacity()
+            + _probeBuffer.capacity();
+    return usage;
+}
+
+CsvColumnMemoryUsage CsvHandler::measureColumnMemory(unsigned int columnIndex,
+        long long sampleStep) {
+    CsvColumnMemoryUsage usage;
+    // Stores keep their memory between chunks, so they are counted even
+    // for columns currently kept as elements.
+    if (columnIndex < _columnStores.size()) {
+        const CsvColumnStore& store = _columnStores[columnIndex];
+        usage.stringPayloads += store.getStringMemoryUsage();
+        usage.vectorCapacity += store.getMemoryUsage() - store.getStringMemoryUsage();
+    }
+    if (columnIndex >= _sourceFileVector.size()) return usage;
+
+    csv_blockedColumn& column = _sourceFileVector[columnIndex];
+    usage.vectorCapacity += column.capacity() * sizeof (CsvEntryElement*);
+    if (column.empty()) return usage;
+
+    _dataTypes type = _dataTypesMap[_sourceFileColumnTypes[columnIndex]];
+    usage.cellObjects += column.size() * getElementSize(type);
+    if (type == type_string) {
+        long long samplePayload = 0;
+        long long samples = 0;
+        for (long long row = 0; row < column.size(); row += sampleStep) {
+            samplePayload += estimateStringPayload(
+                    column[row]->getStringValue().size());
+            ++samples;
+        }
+        usage.stringPayloads += samplePayload * column.size() / samples;
+    }
+    return usage;
+}
+
+long long CsvHandler::measureStringsMemory(
+        const std::vector<std::string>& strings) {
+    long long memory = strings.capacity() * sizeof (std::string);
+    for (const std::string& text : strings) {
+        if (text.capacity() > std::string().capacity()) {
+            memory += text.capacity() + 1 + _heapAllocationOverhead;
+        }
+    }
+    return memory;
+}
+
+void CsvHandler::setMemoryLimit(long long memoryLimit) {
+    _memoryLimit = memoryLimit;
+}
+
+void CsvHandler::checkMemoryLimit() {
+    if (_memoryLimit <= 0 && !isReadBufferSizeAdaptive()) return;
+    CsvMemoryUsage usage = getMemoryUsage();
+    _chunkStorageMemory = usage.cellObjects + usage.stringPayloads
+            + usage.vectorCapacity + usage.fieldTapes;
+    long long memoryUsage = usage.getTotal();
+    if (_mappedFile != nullptr) memoryUsage += _mappedFile->size();
+    if (_memoryLimit > 0 && memoryUsage > _memoryLimit) {
+        _absoluteEndingIndex = _absoluteBeginningIndex;
+        _entriesInCurrentChunk = 0;
+        clearStorage();
+        throw MemoryLimitExceededException(memoryUsage, _memoryLimit);
+    }
+}
+
+CsvChunk CsvHandler::loadChunkOfFile(std::vector<char>& stitchBuffer) {
+    CsvChunk chunk = _chunkReader->nextChunk();
+    _inFileReadLastPosition += chunk.size;
+
+    // Unfinished entry from previous chunk is placed in front of the new one
+    // so that every entry line is contiguous in a single buffer.
+    long long leftoversSize = _buffLeftovers.size();
+    if (leftoversSize <= chunk.headroom) {
+        chunk.data -= leftoversSize;
+        std::copy(_buffLeftovers.begin(), _buffLeftovers.end(), chunk.data);
+    } else {
+        stitchBuffer.reserve(leftoversSize + chunk.size);
+        stitchBuffer.assign(_buffLeftovers.begin(), _buffLeftovers.end());
+        stitchBuffer.insert(stitchBuffer.end(), chunk.data, chunk.data + chunk.size);
+        chunk.data = stitchBuffer.data();
+    }
+    chunk.size += leftoversSize;
+    chunk.headroom -= std::min(leftoversSize, chunk.headroom);
+    _buffLeftovers.clear();
+    _chunkByteOffset = _inFileReadLastPosition - chunk.size;
+    return chunk;
+}
+
+void CsvHandler::enableReadAhead(bool readAhead) {
+    _readAheadFlag = readAhead;
+}
+
+void CsvHandler::setRejectSink(CsvRejectSink* rejectSink) {
+    _rejectSink = rejectSink;
+}
+
+void CsvHandler::selectColumns(const std::vector<int>& columnIndexes) {
+    _selectedCaptions.clear();
+    _selectedColumns = columnIndexes;
+}
+
+void CsvHandler::selectColumns(const std::vector<std::string>& columnCaptions) {
+    _selectedColumns.clear();
+    _selectedCaptions = columnCaptions;
+}
+
+void CsvHandler::addRowFilter(int columnIndex, _comparisonOperator comparison,
+        double value) {
+    RowFilter filter;
+    filter.kind = filter_number;
+    filter.comparison = comparison;
+    filter.number = value;
+    addRowFilter(filter, columnIndex, _emptyString);
+}
+
+void CsvHandler::addRowFilter(const std::string& columnCaption,
+        _comparisonOperator comparison, double value) {
+    RowFilter filter;
+    filter.kind = filter_number;
+    filter.comparison = comparison;
+    filter.number = value;
+    addRowFilter(filter, -1, columnCaption);
+}
+
+void CsvHandler::addRowFilter(int columnIndex, _comparisonOperator comparison,
+        const std::string& value) {
+    RowFilter filter;
+    filter.kind = filter_text;
+    filter.comparison = comparison;
+    filter.text = value;
+    addRowFilter(filter, columnIndex, _emptyString);
+}
+
+void CsvHandler::addRowFilter(const std::string& columnCaption,
+        _comparisonOperator comparison, const std::string& value) {
+    RowFilter filter;
+    filter.kind = filter_text;
+    filter.comparison = comparison;
+    filter.text = value;
+    addRowFilter(filter, -1, columnCaption);
+}
+
+void CsvHandler::addRegexFilter(int columnIndex, const std::string& regex) {
+    RowFilter filter;
+    filter.kind = filter_regex;
+    filter.pattern = std::regex(regex);
+    addRowFilter(filter, columnIndex, _emptyString);
+}
+
+void CsvHandler::addRegexFilter(const std::string& columnCaption,
+        const std::string& regex) {
+    RowFilter filter;
+    filter.kind = filter_regex;
+    filter.pattern = std::regex(regex);
+    addRowFilter(filter, -1, columnCaption);
+}
+
+void CsvHandler::addRowFilter(RowFilter& filter, int columnIndex,
+        const std::string& columnCaption) {
+    filter.columnIndex = columnIndex;
+    filter.columnCaption = columnCaption;
+    filter.columnType = type_string;
+    filter.numericComparison = filter.kind == filter_number;
+    _rowFilters.push_back(filter);
+}
+
+void CsvHandler::clearRowFilters() {
+    _rowFilters.clear();
+}
+
+void CsvHandler::prepareRowFilters() {
+    for (RowFilter& filter : _rowFilters) {
+        if (!filter.columnCaption.empty()) {
+            auto captionIt = std::find(_inFileHeader.begin(), _inFileHeader.end(),
+                    filter.columnCaption);
+            if (captionIt == _inFileHeader.end()) {
+                throw InvalidColumnCaptionException("Column caption "
+                        + filter.columnCaption + " is not valid.");
+            }
+            filter.columnIndex = captionIt - _inFileHeader.begin();
+        }
+        if (filter.columnIndex < 0
+                || filter.columnIndex >= (int) _inFileColumnTypes.size()) {
+            throw std::out_of_range("Filtered column index is out of range!");
+        }
+        filter.columnType = _dataTypesMap.at(_inFileColumnTypes[filter.columnIndex]);
+
+        if (filter.kind == filter_text) {
+            std::time_t dateValue;
+            const char* textEnd = filter.text.data() + filter.text.size();
+            filter.numericComparison = false;
+            if (filter.columnType == type_date) {
+                if (_dateFormat.parse(filter.text.data(), textEnd, dateValue) == parse_ok) {
+                    filter.number = dateValue;
+                    filter.numericComparison = true;
+                }
+            } else if (filter.columnType != type_string) {
+                filter.numericComparison = CsvFieldParser::parseDouble(
+                        filter.text.data(), textEnd, filter.number) == parse_ok;
+            }
+        }
+    }
+}
+
+bool CsvHandler::matchesRowFilters(const CsvFieldTape& tape, long long tapeRow) {
+    for (const RowFilter& filter : _rowFilters) {
+        CsvStringSlice field = tape.getField(tapeRow, filter.columnIndex);
+        if (filter.kind == filter_regex) {
+            if (!std::regex_search(field.begin(), field.end(), filter.pattern)) {
+                return false;
+            }
+            continue;
+        }
+
+        int order;
+        if (filter.numericComparison) {
+            double value;
+            _parseStatus status;
+            if (filter.columnType == type_int) {
+                int intValue;
+                status = CsvFieldParser::parseInt(field.begin(), field.end(), intValue);
+                value = intValue;
+            } else if (filter.columnType == type_int64) {
+                long long int64Value;
+                status = CsvFieldParser::parseInt64(field.begin(), field.end(),
+                        int64Value);
+                value = int64Value;
+            } else if (filter.columnType == type_date) {
+                std::time_t dateValue;
+                status = _dateFormat.parse(field.begin(), field.end(), dateValue);
+                value = dateValue;
+            } else {
+                status = CsvFieldParser::parseDouble(field.begin(), field.end(), value);
+            }
+            if (status != parse_ok) return false;
+            order = value < filter.number ? -1 : (value > filter.number ? 1 : 0);
+        } else {
+            order = field.compare(filter.text);
+        }
+
+        bool matched;
+        switch (filter.comparison) {
+            case op_equal: matched = order == 0;
+                break;
+            case op_not_equal: matched = order != 0;
+                break;
+            case op_less: matched = order < 0;
+                break;
+            case op_less_equal: matched = order <= 0;
+                break;
+            case op_greater: matched = order > 0;
+                break;
+            default: matched = order >= 0;
+                break;
+        }
+        if (!matched) return false;
+    }
+    return true;
+}
+
+void CsvHandler::enableLazyParsing(bool lazyParsing) {
+    _lazyParsingFlag = lazyParsing;
+}
+
+void CsvHandler::enableDictionaryEncoding(bool dictionaryEncoding) {
+    _dictionaryEncodingFlag = dictionaryEncoding;
+}
+
+void CsvHandler::enableIntegerNarrowing(bool integerNarrowing) {
+    _integerNarrowingFlag = integerNarrowing;
+}
+
+void CsvHandler::parseColumn(int columnIndex) {
+    if (_columnStates.empty() || _columnStates[columnIndex] != column_on_tape) return;
+
+    _dataTypes type = _dataTypesMap.at(_sourceFileColumnTypes[columnIndex]);
+    CsvColumnStore& store = _columnStores[columnIndex];
+    unsigned int threads = countParserThreads(_entriesInCurrentChunk,
+            _minEntriesPerParserThread);
+    // Bitmap words are shared by neighbouring ranges,
+    // so unset fields are marked after all threads finished.
+    std::vector<std::vector<long long> > unsetEntries(threads);
+    try {
+        if (type == type_string) {
+            store.assignStrings(_entriesInCurrentChunk);
+            runInParallel(threads, _entriesInCurrentChunk,
+                    [&](unsigned int, long long rangeBegin, long long rangeEnd) {
+                        for (long long entry = rangeBegin; entry < rangeEnd; ++entry) {
+                            store.setStringLength(entry,
+                                    getTapeField(entry, columnIndex).size());
+                        }
+                    });
+            store.allocateStrings();
+            runInParallel(threads, _entriesInCurrentChunk,
+                    [&](unsigned int, long long rangeBegin, long long rangeEnd) {
+                        for (long long entry = rangeBegin; entry < rangeEnd; ++entry) {
+                            store.setString(entry,
+                                    getTapeField(entry, columnIndex).data());
+                        }
+                    });
+            if (_dictionaryEncodingFlag) {
+                store.encodeDictionary(
+                        _entriesInCurrentChunk / _dictionaryRowsPerValue);
+            }
+        } else {
+            if (type == type_int) {
+                store.assign<int>(_entriesInCurrentChunk);
+            } else if (type == type_int64) {
+                store.assign<long long>(_entriesInCurrentChunk);
+            } else if (type == type_double) {
+                store.assign<double>(_entriesInCurrentChunk);
+            } else {
+                store.assign<CsvDate>(_entriesInCurrentChunk);
+            }
+            runInParallel(threads, _entriesInCurrentChunk,
+                    [&](unsigned int rangeId, long long rangeBegin, long long rangeEnd) {
+                        for (long long entry = rangeBegin; entry < rangeEnd; ++entry) {
+                            if (!setStoredValue(store, entry, type,
+                                    getTapeField(entry, columnIndex), entry,
+                                    _lazyErrorHandlingMode)) {
+                                unsetEntries[rangeId].push_back(entry);
+                            }
+                        }
+                    });
+            if (_integerNarrowingFlag) store.narrowIntegers();
+        }
+    } catch (...) {
+        store.clear();
+        throw;
+    }
+    for (const std::vector<long long>& entries : unsetEntries) {
+        for (long long entry : entries) store.notSet(entry);
+    }
+    _columnStates[columnIndex] = column_stored;
+}
+
+void CsvHandler::parseAllColumns() {
+    for (unsigned int columnId = 0; columnId < _columnStates.size(); ++columnId) {
+        parseColumn(columnId);
+    }
+}
+
+void CsvHandler::materializeColumn(int columnIndex) {
+    if (_columnStates.empty() || _columnStates[columnIndex] == column_elements) return;
+    parseColumn(columnIndex);
+
+    _dataTypes type = _dataTypesMap.at(_sourceFileColumnTypes[columnIndex]);
+    CsvColumnStore& store = _columnStores[columnIndex];
+    csv_blockedColumn& column = _sourceFileVector[columnIndex];
+    column.assign(_entriesInCurrentChunk, nullptr);
+    unsigned int threads = countParserThreads(_entriesInCurrentChunk,
+            _minEntriesPerParserThread);
+    runInParallel(threads, _entriesInCurrentChunk,
+            [&](unsigned int rangeId, long long rangeBegin, long long rangeEnd) {
+                for (long long entry = rangeBegin; entry < rangeEnd; ++entry) {
+                    CsvEntryElement* field = newEntryElement(type, rangeId);
+                    switch (type) {
+                        case type_int:
+                            setSingleEntryElementValue<int>(field,
+                                    (int) store.getInteger(entry));
+                            break;
+                        case type_int64:
+                            setSingleEntryElementValue<long long>(field,
+                                    store.getInteger(entry));
+                            break;
+                        case type_double:
+                            setSingleEntryElementValue<double>(field,
+                                    store.value<double>(entry));
+                            break;
+                        case type_date:
+                            setSingleEntryElementValue<std::time_t>(field,
+                                    store.value<CsvDate>(entry));
+                            break;
+                        default:
+                            setSingleEntryElementValue<std::string>(field,
+                                    store.getString(entry).toString());
+                            break;
+                    }
+                    if (!store.isSet(entry)) field->notSet();
+                    column[entry] = field;
+                }
+            });
+    store.clear();
+    _columnStates[columnIndex] = column_elements;
+}
+
+void CsvHandler::materializeAllColumns() {
+    for (unsigned int columnId = 0; columnId < _columnStates.size(); ++columnId) {
+        materializeColumn(columnId);
+    }
+    _columnStates.clear();
+    _columnStores.clear();
+}
+
+template <class V>
+void CsvHandler::storeElementValues(int columnIndex, CsvColumnStore& store) {
+    csv_blockedColumn& column = _sourceFileVector[columnIndex];
+    long long rows = column.size();
+    store.assign<V>(rows);
+    for (long long row = 0; row < rows; ++row) {
+        auto* typedElement = dynamic_cast<CsvTypedEntryElement<
+                typename CsvStoredValue<V>::type>*> (column[row]);
+        if (typedElement == nullptr) {
+            // Elements are kept, column stays usable by element API.
+            std::stringstream msg;
+            msg << "Row " << row << " of column " << columnIndex
+                    << " is not of column type "
+                    << _sourceFileColumnTypes[columnIndex];
+            throw UnableToConvertFieldTypeException(msg.str());
+        }
+        store.values<V>()[row] = typedElement->getValue();
+    }
+}
+
+CsvColumnStore& CsvHandler::getStoredColumn(int columnIndex, _dataTypes type) {
+    if (columnIndex < 0 || columnIndex >= (int) _sourceFileColumnTypes.size()) {
+        throw std::out_of_range("Column index is out of range!");
+    }
+    if (_dataTypesMap.at(_sourceFileColumnTypes[columnIndex]) != type) {
+        std::stringstream msg;
+        msg << "Column " << columnIndex << " is of type "
+                << _sourceFileColumnTypes[columnIndex] << ", not "
+                << getDataTypeAsString(type);
+        throw UnableToConvertFieldTypeException(msg.str());
+    }
+    compactRows();
+    if (_columnStates.empty()) {
+        _columnStates.assign(_sourceFileColumnTypes.size(), column_elements);
+        _columnStores.resize(_sourceFileColumnTypes.size());
+    }
+    parseColumn(columnIndex);
+
+    CsvColumnStore& store = _columnStores[columnIndex];
+    if (_columnStates[columnIndex] == column_elements) {
+        csv_blockedColumn& column = _sourceFileVector[columnIndex];
+        long long rows = column.size();
+        if (type == type_string) {
+            store.assignStrings(rows);
+            std::vector<std::string> values(rows);
+            for (long long row = 0; row < rows; ++row) {
+                values[row] = column[row]->getStringValue();
+                store.setStringLength(row, values[row].size());
+            }
+            store.allocateStrings();
+            for (long long row = 0; row < rows; ++row) {
+                store.setString(row, values[row].data());
+            }
+        } else if (type == type_int) {
+            storeElementValues<int>(columnIndex, store);
+        } else if (type == type_int64) {
+            storeElementValues<long long>(columnIndex, store);
+        } else if (type == type_double) {
+            storeElementValues<double>(columnIndex, store);
+        } else {
+            storeElementValues<CsvDate>(columnIndex, store);
+        }
+        for (long long row = 0; row < rows; ++row) {
+            if (!column[row]->isSet()) store.notSet(row);
+            deleteEntryElement(column[row]);
+        }
+        column.clear();
+        _columnStates[columnIndex] = column_stored;
+    }
+    store.mergeRowGroups();
+    return store;
+}
+
+CsvColumnSpan<int> CsvHandler::getIntColumn(int columnIndex) {
+    CsvColumnStore& store = getStoredColumn(columnIndex, type_int);
+    store.widen<int>();
+    return store.getSpan<int>();
+}
+
+CsvColumnSpan<long long> CsvHandler::getInt64Column(int columnIndex) {
+    CsvColumnStore& store = getStoredColumn(columnIndex, type_int64);
+    store.widen<long long>();
+    return store.getSpan<long long>();
+}
+
+CsvColumnSpan<double> CsvHandler::getDoubleColumn(int columnIndex) {
+    return getStoredColumn(columnIndex, type_double).getSpan<double>();
+}
+
+CsvColumnSpan<std::time_t> CsvHandler::getDateColumn(int columnIndex) {
+    return getStoredColumn(columnIndex, type_date).getSpan<CsvDate>();
+}
+
+const CsvColumnStore& CsvHandler::getColumnStore(int columnIndex) {
+    if (columnIndex < 0 || columnIndex >= (int) _sourceFileColumnTypes.size()) {
+        throw std::out_of_range("Column index is out of range!");
     }
-    std::vector<char> data(_readBufferSize);
-    loadChunkOfFile(data);
-    if (_loadDataModeFlag == load_in_chunks) ++_chunksCount;
-    if (_inFileFormatFlag == CSV) loadEntries_CSV(data, errorHandlingMode);
-    else if (_inFileFormatFlag == JSON) loadEntries_JSON(data, errorHandlingMode);
+    return getStoredColumn(columnIndex,
+            _dataTypesMap.at(_sourceFileColumnTypes[columnIndex]));
+}
+
+void CsvHandler::writeField(std::ostream& out, int columnIndex, long long row) {
+    if (_columnStates.empty() || _columnStates[columnIndex] == column_elements) {
+        out << _sourceFileVector[columnIndex][row]->getStringValue();
+        return;
+    }
+    const CsvColumnStore& store = _columnStores[columnIndex];
+    switch (_dataTypesMap.at(_sourceFileColumnTypes[columnIndex])) {
+        case type_int:
+        case type_int64:
+            out << store.getInteger(row);
+            break;
+        case type_double:
+            out << store.value<double>(row);
+            break;
+        case type_date:
+            out << _dateFormat.format(store.value<CsvDate>(row));
+            break;
+        default:
+            out << store.getString(row);
+            break;
+    }
+}
 
+bool CsvHandler::isDictionaryColumn(int columnIndex) {
+    return !_columnStates.empty()
+            && _columnStates[columnIndex] == column_stored
+            && _columnStores[columnIndex].isDictionaryEncoded();
+}
+
+std::vector<int> CsvHandler::countDictionaryMatches(int columnIndex,
+        const std::regex& regex) {
+    const CsvColumnStore& store = _columnStores[columnIndex];
+    std::vector<int> matchCounts(store.getDictionarySize(), 0);
+    std::smatch matches;
+    for (long long code = 0; code < store.getDictionarySize(); ++code) {
+        std::string s = store.getDictionaryValue(code).toString();
+        std::regex_search(s, matches, regex);
+        for (std::string ms : matches) {
+            if (!ms.empty()) ++matchCounts[code];
+        }
+    }
+    return matchCounts;
+}
+
+bool CsvHandler::isFieldSet(int columnIndex, long long row) {
+    if (_columnStates.empty() || _columnStates[columnIndex] == column_elements) {
+        return _sourceFileVector[columnIndex][row]->isSet();
+    }
+    return _columnStores[columnIndex].isSet(row);
+}
+
+CsvStringSlice CsvHandler::getTapeField(long long entryIndex, int columnIndex) {
+    unsigned int tapeId;
+    long long tapeRow;
+    locateTapeEntry(entryIndex, tapeId, tapeRow);
+    return _fieldTapes[tapeId].getField(tapeRow, getFileColumn(columnIndex));
+}
+
+void CsvHandler::locateTapeEntry(long long entryIndex, unsigned int& tapeId,
+        long long& tapeRow) {
+    long long row = _entryRows.empty() ? entryIndex : _entryRows[entryIndex];
+    tapeId = std::upper_bound(_tapeFirstEntries.begin(),
+            _tapeFirstEntries.end(), row) - _tapeFirstEntries.begin() - 1;
+    tapeRow = row - _tapeFirstEntries[tapeId];
+}
+
+long long CsvHandler::getIoWaitTime() {
+    return _chunkReader != nullptr ? _chunkReader->getWaitTime() : 0;
+}
+
+long long CsvHandler::forEachRow(const csv_rowCallback& callback,
+        _errorHandlingMode errorHandlingMode) {
+    // Visiting rewinds the reader, loaded chunk must not reference it.
+    parseAllColumns();
+    // Header line is visited as row -1 and skipped.
+    long long rowIndex = _inFileFormatFlag == CSV
+            && _headerModeFlag != no_header ? -1 : 0;
+    unsigned long expectedColumns = !_inFileColumnTypes.empty() ?
+            _inFileColumnTypes.size() : _inFileHeader.size();
+    _buffLeftovers.clear();
+    _inFileReadLastPosition = 0;
+    _linesRead = 0;
+
+    if (_loadDataModeFlag == load_mmap) {
+        if (_mappedFile == nullptr) _mappedFile = new CsvMappedFile(_inFileName);
+        _chunkByteOffset = 0;
+        visitEntries(_mappedFile->data(), _mappedFile->size(), true,
+                callback, errorHandlingMode, rowIndex, expectedColumns);
+        if (_rejectSink != nullptr) _rejectSink->finish();
+        return std::max(rowIndex, 0LL);
+    }
+
+    long long chunkSize = _loadDataModeFlag == load_in_chunks ?
+            _readBufferSize : _rowStreamChunkSize;
+    if (_chunkReader == nullptr) {
+        _chunkReader = new CsvChunkReader(_dataSource, _probeBuffer,
+                chunkSize, _readAheadFlag);
+    } else {
+        _chunkReader->rewind();
+        _chunkReader->setChunkSize(chunkSize);
+    }
+
+    std::vector<char> stitchBuffer;
+    CsvChunk chunk;
+    bool proceed = true;
+    do {
+        chunk = loadChunkOfFile(stitchBuffer);
+        proceed = visitEntries(chunk.data, chunk.size, chunk.last,
+                callback, errorHandlingMode, rowIndex, expectedColumns);
+    } while (proceed && !chunk.last);
+
+    if (_rejectSink != nullptr) _rejectSink->finish();
+    _buffLeftovers.clear();
+    if (_loadDataModeFlag == load_in_chunks) _eofFlag = true;
+    return std::max(rowIndex, 0LL);
+}
+
+bool CsvHandler::visitEntries(const char* data, long long size, bool lastChunk,
+        const csv_rowCallback& callback, _errorHandlingMode errMode,
+        long long& rowIndex, unsigned long& expectedColumns) {
+    csv_entrySlices fields;
+    fields.reserve(expectedColumns);
+
+    if (_inFileFormatFlag == JSON) {
+        csv_entryLine jsonEntryHolder;
+        std::vector<std::string> entries =
+                convertCharBufferIntoJSONentryStrings(data, size);
+        for (std::string& entry : entries) {
+            if (_inFileHeader.empty()) {
+                buildPropertyLineFromJSONentry(entry, _inFileHeader);
+                _sourceFileHeader = _inFileHeader;
+            }
+            jsonEntryHolder.clear();
+            buildEntryLineFromJSONentry(entry, jsonEntryHolder,
+                    _jsonValue, include_header);
+            fields.assign(jsonEntryHolder.begin(), jsonEntryHolder.end());
+            ++_linesRead;
+            if (!visitEntry(fields, entry, -1, callback, errMode,
+                    rowIndex, expectedColumns)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* lineBegin = data;
+    const char* bufferEnd = data + size;
+    CsvLineCursor cursor = _scanner.findLineEndings(data, bufferEnd);
+    while (lineBegin < bufferEnd) {
+        const char* current = _scanner.nextLineEnding(cursor);
+        if (current == bufferEnd && !lastChunk) {
+            _buffLeftovers.assign(lineBegin, bufferEnd);
+            break;
+        }
+
+        if (current > lineBegin) {
+            CsvStringSlice line(lineBegin, current - lineBegin);
+            ++_linesRead;
+            if (rowIndex < 0) {
+                ++rowIndex;
+            } else {
+                fields.clear();
+                splitEntryByDelimiter(line, fields, _csvDelimiter);
+                if (!visitEntry(fields, line, _chunkByteOffset + (lineBegin - data),
+                        callback, errMode, rowIndex, expectedColumns)) {
+                    return false;
+                }
+            }
+        }
+        lineBegin = current + 1;
+    }
     return true;
 }
 
-void CsvHandler::loadChunkOfFile(std::vector<char>& data) {
-    std::ifstream fstream(_inFileName);
+bool CsvHandler::visitEntry(const csv_entrySlices& fields,
+        const CsvStringSlice& line, long long byteOffset,
+        const csv_rowCallback& callback, _errorHandlingMode errMode,
+        long long& rowIndex, unsigned long& expectedColumns) {
+    if (expectedColumns == 0) expectedColumns = fields.size();
 
-    if (fstream) {
-        fstream.seekg(_inFileReadLastPosition);
-        if (fstream.read(&data[0], _readBufferSize)) {
-            _inFileReadLastPosition = fstream.tellg();
-            return;
+    if (fields.size() != expectedColumns) {
+        if (errMode == stop_on_error) {
+            throw UnableToSplitEntryException(rowIndex, fields.size(),
+                    expectedColumns);
         }
+        rejectEntry(line, _linesRead, byteOffset, fields.size(),
+                expectedColumns);
+        return true;
     }
-    throw UnableToOpenFileException();
+    return callback(CsvRowView(fields, rowIndex++, &_dateFormat));
 }
 
-void CsvHandler::loadEntries_CSV(std::vector<char>& data,
+void CsvHandler::rejectEntry(const CsvStringSlice& line, long long lineNumber,
+        long long byteOffset, long long amountOfFields,
+        long long expectedFields) {
+    if (_rejectSink == nullptr) return;
+    CsvRejectedEntry entry;
+    entry.lineNumber = lineNumber;
+    entry.byteOffset = byteOffset;
+    entry.amountOfFields = amountOfFields;
+    entry.expectedFields = expectedFields;
+    entry.line = line;
+    _rejectSink->reject(entry);
+}
+
+void CsvHandler::loadEntries_CSV(const char* data, long long size,
         _errorHandlingMode errMode) {
 
     if (_sourceFileColumnTypes.empty()) autoDetectTypesForColumns();
-    std::vector<std::string> entryLines = convertCharBufferIntoCSVentryStrings(data);
-
-    if (!entryLines.empty()) {
-        if (loadHeader(entryLines.front())) entryLines.erase(entryLines.begin());
-        _sourceFileColumnTypes = _inFileColumnTypes;
-        _sourceFileHeader = _inFileHeader;
-        _absoluteEndingIndex += entryLines.size();
-        _absoluteBeginningIndex = _absoluteEndingIndex - entryLines.size();
-        _entriesInCurrentChunk = entryLines.size();
+    long long amountOfEntries = tokenizeCharBuffer(data, size);
+    _chunkFirstLine = _linesRead + 1;
+    _linesRead += amountOfEntries;
+
+    if (amountOfEntries > 0) {
+        for (CsvFieldTape& tape : _fieldTapes) {
+            if (tape.getAmountOfRows() == 0) continue;
+            if (loadHeader(tape.getLine(0))) {
+                tape.dropFirstRow();
+                --amountOfEntries;
+                ++_chunkFirstLine;
+            }
+            break;
+        }
+        applyColumnSelection();
+        amountOfEntries = selectEntries(errMode);
+        _absoluteEndingIndex += amountOfEntries;
+        _absoluteBeginningIndex = _absoluteEndingIndex - amountOfEntries;
+        _entriesInCurrentChunk = amountOfEntries;
         initializeStorage();
-        emplaceEntriesInStorage(entryLines, CSV, errMode);
+        emplaceEntriesInStorage(errMode);
+        checkMemoryLimit();
     }
 }
 
-void CsvHandler::loadEntries_JSON(std::vector<char>& data,
+void CsvHandler::loadEntries_JSON(const char* data, long long size,
         _errorHandlingMode errMode) {
 
     std::vector<std::string> entryLines =
-            convertCharBufferIntoJSONentryStrings(data);
+            convertCharBufferIntoJSONentryStrings(data, size);
     if (!entryLines.empty()) {
 
         std::vector<std::string> firstLine;
@@ -460,47 +1642,92 @@ void CsvHandler::loadEntries_JSON(std::vector<char>& data,
 
         }
 
-        _sourceFileColumnTypes = _inFileColumnTypes;
-        _sourceFileHeader = _inFileHeader;
-        _absoluteEndingIndex += entryLines.size();
-        _absoluteBeginningIndex = _absoluteEndingIndex - entryLines.size();
-        _entriesInCurrentChunk = entryLines.size();
+        applyColumnSelection();
+        tokenizeJSONentries(entryLines);
+        _chunkFirstLine = _linesRead + 1;
+        _linesRead += entryLines.size();
+        long long amountOfEntries = selectEntries(errMode);
+        _absoluteEndingIndex += amountOfEntries;
+        _absoluteBeginningIndex = _absoluteEndingIndex - amountOfEntries;
+        _entriesInCurrentChunk = amountOfEntries;
         initializeStorage();
-        emplaceEntriesInStorage(entryLines, JSON, errMode);
+        emplaceEntriesInStorage(errMode);
+        checkMemoryLimit();
     }
 
 }
 
-std::vector<std::string> CsvHandler::convertCharBufferIntoCSVentryStrings(
-        std::vector<char> partialData) {
-    std::vector<std::string> lineBuff;
-    std::string buff = _buffLeftovers;
-    _buffLeftovers.clear();
-    for (const char character : partialData) {
-        if (character != _LF && character != _CR ) buff += character;
-        else if (buff.size() && (buff.size() > _sourceFileColumnTypes.size() - 1)) {
-            lineBuff.push_back(buff);
-            buff.clear();
-        }
+long long CsvHandler::tokenizeCharBuffer(const char* data, long long size) {
+    const char* bufferEnd = data + size;
+    unsigned int threads = countParserThreads(size, _minBytesPerParserThread);
+
+    // Segments start right after a line ending, so no entry is cut.
+    std::vector<const char*> segments(threads + 1, bufferEnd);
+    segments[0] = data;
+    for (unsigned int segmentId = 1; segmentId < threads; ++segmentId) {
+        const char* segmentBegin = std::max(data + size * segmentId / threads,
+                segments[segmentId - 1]);
+        CsvLineCursor cursor = _scanner.findLineEndings(segmentBegin, bufferEnd);
+        const char* lineEnding = _scanner.nextLineEnding(cursor);
+        segments[segmentId] = lineEnding < bufferEnd ? lineEnding + 1 : bufferEnd;
     }
-    if (buff.size()) {
-        _buffLeftovers = buff;
-        if (_eofFlag && (buff.size() > _sourceFileColumnTypes.size() - 1))
-            lineBuff.push_back(buff);
+
+    _fieldTapes.resize(threads);
+    const char* lineBegin = data;
+    runInParallel(threads, threads,
+            [&](unsigned int segmentId, long long, long long) {
+                CsvFieldTape& tape = _fieldTapes[segmentId];
+                tape.clear(data);
+                const char* unfinishedLine = _scanner.tokenize(
+                        segments[segmentId], segments[segmentId + 1], tape,
+                        _eofFlag && segmentId == threads - 1);
+                if (segmentId == threads - 1) lineBegin = unfinishedLine;
+            });
+
+    if (lineBegin < bufferEnd) {
+        _buffLeftovers.assign(lineBegin, bufferEnd);
     }
-    return lineBuff;
+
+    long long amountOfEntries = 0;
+    for (const CsvFieldTape& tape : _fieldTapes) {
+        amountOfEntries += tape.getAmountOfRows();
+    }
+    return amountOfEntries;
+}
+
+void CsvHandler::tokenizeJSONentries(const std::vector<std::string>& entryLines) {
+    unsigned int threads = countParserThreads(entryLines.size(),
+            _minEntriesPerParserThread);
+    _fieldTapes.resize(threads);
+    for (CsvFieldTape& tape : _fieldTapes) {
+        tape.clear(nullptr);
+    }
+
+    runInParallel(threads, entryLines.size(),
+            [&](unsigned int rangeId, long long rangeBegin, long long rangeEnd) {
+                csv_entryLine jsonEntryHolder;
+                for (long long cEntry = rangeBegin; cEntry < rangeEnd; ++cEntry) {
+                    std::string jsonEntry = entryLines[cEntry];
+                    jsonEntryHolder.clear();
+                    buildEntryLineFromJSONentry(jsonEntry, jsonEntryHolder,
+                            _jsonValue, include_header);
+                    _fieldTapes[rangeId].addOwnedRow(entryLines[cEntry],
+                            jsonEntryHolder);
+                }
+            });
 }
 
 std::vector<std::string> CsvHandler::convertCharBufferIntoJSONentryStrings(
-        std::vector<char> partialData) {
+        const char* data, long long size) {
     std::vector<std::string> lineBuff;
     std::regex rEntry(R"(\{[^\{]*\})");
-    std::string buff = _buffLeftovers;
+    std::string buff;
     std::smatch matches;
 
-    for (const char character : partialData) {
-        if (character != _LF && character != _CR )
-            buff += character;
+    buff.reserve(size);
+    for (const char* current = data; current < data + size; ++current) {
+        if (*current != _LF && *current != _CR)
+            buff += *current;
     }
 
     std::string::const_iterator searchStart(buff.cbegin());
@@ -518,39 +1745,85 @@ std::vector<std::string> CsvHandler::convertCharBufferIntoJSONentryStrings(
     return lineBuff;
 }
 
-void CsvHandler::emplaceEntriesInStorage(std::vector<std::string>& entryLines,
-        _fileFormat fileFormat, _errorHandlingMode errorHandlingMode) {
-    csv_entryLine splittedEntryHolder;
-    splittedEntryHolder.reserve(_inFileColumnTypes.size());
+long long CsvHandler::selectEntries(_errorHandlingMode errorHandlingMode) {
+    unsigned int tapes = _fieldTapes.size();
+    _tapeFirstEntries.assign(tapes + 1, 0);
+    for (unsigned int tapeId = 0; tapeId < tapes; ++tapeId) {
+        _tapeFirstEntries[tapeId + 1] = _tapeFirstEntries[tapeId]
+                + _fieldTapes[tapeId].getAmountOfRows();
+    }
+    prepareRowFilters();
 
-    for (unsigned long cEntry = 0; cEntry < entryLines.size(); ++cEntry) {
-        splittedEntryHolder.erase(splittedEntryHolder.begin(),
-                splittedEntryHolder.end());
-        if (fileFormat == CSV) {
-            splitEntryByDelimiter(entryLines[cEntry], splittedEntryHolder,
-                    _csvDelimiter);
-        } else if (fileFormat == JSON) {
-            buildEntryLineFromJSONentry(entryLines[cEntry], splittedEntryHolder,
-                    _jsonValue, include_header);
+    std::vector<std::vector<long long> > rejectedEntries(tapes);
+    std::vector<std::vector<long long> > skippedEntries(tapes);
+    runInParallel(tapes, tapes,
+            [&](unsigned int, long long rangeBegin, long long rangeEnd) {
+                for (long long tapeId = rangeBegin; tapeId < rangeEnd; ++tapeId) {
+                    selectTapeEntries(tapeId, errorHandlingMode,
+                            rejectedEntries[tapeId], skippedEntries[tapeId]);
+                }
+            });
+
+    long long amountOfSkipped = 0;
+    for (unsigned int tapeId = 0; tapeId < tapes; ++tapeId) {
+        const CsvFieldTape& tape = _fieldTapes[tapeId];
+        for (long long cEntry : rejectedEntries[tapeId]) {
+            long long tapeRow = cEntry - _tapeFirstEntries[tapeId];
+            rejectEntry(tape.getLine(tapeRow), _chunkFirstLine + cEntry,
+                    _inFileFormatFlag == CSV ?
+                    _chunkByteOffset + tape.getLineOffset(tapeRow) : -1,
+                    tape.getAmountOfFields(tapeRow), _inFileColumnTypes.size());
         }
-        if (splittedEntryHolder.size() == _inFileColumnTypes.size()) {
-            setColumnsForEntry(splittedEntryHolder, cEntry, errorHandlingMode);
-        } else if (errorHandlingMode == stop_on_error) {
-            std::cerr << "Error in line: " << entryLines[cEntry] << "\nSplitted size: " << splittedEntryHolder.size() << std::endl;
-            throw UnableToSplitEntryException(_absoluteBeginningIndex + cEntry);
-        } else {
-            std::cerr << "Rejected line: " << entryLines[cEntry] << std::endl;
-            entryLines.erase(entryLines.begin() + cEntry);
-            for (auto cCol = _sourceFileVector.begin(); cCol < _sourceFileVector.end(); ++cCol) {
-                delete (*cCol)[cEntry];
-                (*cCol).erase((*cCol).begin() + cEntry);
+        amountOfSkipped += skippedEntries[tapeId].size();
+    }
+    if (_rejectSink != nullptr) _rejectSink->flush();
+
+    // Storage is created only for selected entries, skipped ones are
+    // left out of the tape rows mapping.
+    _entryRows.clear();
+    if (amountOfSkipped > 0) {
+        _entryRows.reserve(_tapeFirstEntries.back() - amountOfSkipped);
+        for (unsigned int tapeId = 0; tapeId < tapes; ++tapeId) {
+            auto skippedIt = skippedEntries[tapeId].begin();
+            for (long long row = _tapeFirstEntries[tapeId]; row < _tapeFirstEntries[tapeId + 1]; ++row) {
+                if (skippedIt != skippedEntries[tapeId].end() && *skippedIt == row) {
+                    ++skippedIt;
+                } else {
+                    _entryRows.push_back(row);
+                }
             }
-            _entriesInCurrentChunk--;
-            _absoluteEndingIndex--;
+        }
+    }
+    return _tapeFirstEntries.back() - amountOfSkipped;
+}
+
+void CsvHandler::selectTapeEntries(unsigned int tapeId,
+        _errorHandlingMode errorHandlingMode,
+        std::vector<long long>& rejectedEntries,
+        std::vector<long long>& skippedEntries) {
+    const CsvFieldTape& tape = _fieldTapes[tapeId];
+    for (long long tapeRow = 0; tapeRow < tape.getAmountOfRows(); ++tapeRow) {
+        long long cEntry = _tapeFirstEntries[tapeId] + tapeRow;
+        long long amountOfFields = tape.getAmountOfFields(tapeRow);
+        if (amountOfFields != (long long) _inFileColumnTypes.size()) {
+            if (errorHandlingMode == stop_on_error) {
+                throw UnableToSplitEntryException(_absoluteEndingIndex + cEntry,
+                        amountOfFields, _inFileColumnTypes.size());
+            }
+            rejectedEntries.push_back(cEntry);
+            skippedEntries.push_back(cEntry);
+        } else if (!matchesRowFilters(tape, tapeRow)) {
+            skippedEntries.push_back(cEntry);
         }
     }
 }
 
+void CsvHandler::emplaceEntriesInStorage(_errorHandlingMode errorHandlingMode) {
+    _lazyErrorHandlingMode = errorHandlingMode;
+    if (_lazyParsingFlag) return;
+    parseAllColumns();
+}
+
 void CsvHandler::buildEntryLineFromJSONentry(
         std::string& jsonEntry, csv_entryLine& entryLine,
         int jsonFieldType, _headerMode hm) {
@@ -584,60 +1857,198 @@ void CsvHandler::buildPropertyLineFromJSONentry(
     buildEntryLineFromJSONentry(jsonEntry, entryLine, _jsonProperty, no_header);
 }
 
-void CsvHandler::setColumnsForEntry(csv_entryLine entry, int entryIndex,
+void CsvHandler::insertEntry(const csv_entryLine& entry, long long entryIndex,
         _errorHandlingMode errorHandlingMode) {
-    int columnIndex = 0;
-    for (std::string entryElement : entry) {
-        _dataTypes dt =
-                _dataTypesMap[_sourceFileColumnTypes[columnIndex]];
-
-        switch (dt) {
-            case type_double:
-            {
-
-                try {
-                    setSingleEntryElementValue<double>(
-                            _sourceFileVector[columnIndex][entryIndex],
-                            convertString<double>(entryElement, entryIndex));
-                } catch (const UnableToConvertFieldTypeException &exc) {
-                    if (errorHandlingMode == ignore_errors) {
-                        setSingleEntryElementValue<double>(
-                                _sourceFileVector[columnIndex][entryIndex], 0.0);
-                        _sourceFileVector[columnIndex][entryIndex]->notSet();
-                    } else {
-                        throw exc;
-                    }
+    // Fields are converted before any column is changed, so entry with
+    // field not matching its column type leaves storage as it was.
+    unsigned int columns = _sourceFileColumnTypes.size();
+    std::vector<CsvEntryElement*> fields(columns, nullptr);
+    std::vector<CsvColumnStore> values(columns);
+    try {
+        for (unsigned int columnIndex = 0; columnIndex < columns; ++columnIndex) {
+            _dataTypes type = _dataTypesMap.at(_sourceFileColumnTypes[columnIndex]);
+            bool hasField = columnIndex < entry.size();
+            CsvStringSlice entrySlice = hasField ?
+                    CsvStringSlice(entry[columnIndex]) : CsvStringSlice();
+            if (_columnStates.empty()
+                    || _columnStates[columnIndex] == column_elements) {
+                fields[columnIndex] = newEntryElement(type);
+                if (hasField) {
+                    setFieldValue(fields[columnIndex], type, entrySlice,
+                            entryIndex, errorHandlingMode);
                 }
-                break;
+                continue;
             }
-            case type_int:
-            {
-                try {
-                    setSingleEntryElementValue<int>(
-                            _sourceFileVector[columnIndex][entryIndex],
-                            convertString<int>(entryElement, entryIndex));
-                } catch (const UnableToConvertFieldTypeException &exc) {
-                    if (errorHandlingMode == ignore_errors) {
-                        setSingleEntryElementValue<int>(
-                                _sourceFileVector[columnIndex][entryIndex], 0);
-                        _sourceFileVector[columnIndex][entryIndex]->notSet();
-                    } else {
-                        throw exc;
-                    }
+            // Tape can not hold inserted entry, column is converted to
+            // its storage instead of fields.
+            parseColumn(columnIndex);
+            CsvColumnStore& value = values[columnIndex];
+            if (type == type_string) {
+                value.assignStrings(1);
+                value.setStringLength(0, entrySlice.size());
+                value.allocateStrings();
+                value.setString(0, entrySlice.data());
+            } else {
+                if (type == type_int) {
+                    value.assign<int>(1);
+                } else if (type == type_int64) {
+                    value.assign<long long>(1);
+                } else if (type == type_double) {
+                    value.assign<double>(1);
+                } else {
+                    value.assign<CsvDate>(1);
+                }
+                if (hasField && !setStoredValue(value, 0, type, entrySlice,
+                        entryIndex, errorHandlingMode)) {
+                    value.notSet(0);
                 }
-                break;
             }
-            default:
-            {
-                setSingleEntryElementValue<std::string>(
-                        _sourceFileVector[columnIndex][entryIndex], entryElement);
-                break;
+            if (!hasField) value.notSetAll();
+        }
+    } catch (...) {
+        for (CsvEntryElement* field : fields) {
+            if (field != nullptr) deleteEntryElement(field);
+        }
+        throw;
+    }
+    for (unsigned int columnIndex = 0; columnIndex < columns; ++columnIndex) {
+        if (fields[columnIndex] != nullptr) {
+            _sourceFileVector[columnIndex].insert(entryIndex, fields[columnIndex]);
+        } else {
+            _columnStores[columnIndex].insertRow(entryIndex, values[columnIndex], 0);
+        }
+    }
+}
+
+void CsvHandler::applyColumnSelection() {
+    _sourceFileColumnTypes = _inFileColumnTypes;
+    _sourceFileHeader = _inFileHeader;
+    if (!_selectedCaptions.empty()) {
+        _selectedColumns.clear();
+        for (const std::string& caption : _selectedCaptions) {
+            _selectedColumns.push_back(getColumnId(caption));
+        }
+    }
+    if (_selectedColumns.empty()) return;
+
+    _sourceFileColumnTypes.clear();
+    _sourceFileHeader.clear();
+    for (int fileColumn : _selectedColumns) {
+        if (fileColumn < 0 || fileColumn >= (int) _inFileColumnTypes.size()) {
+            throw std::out_of_range("Selected column index is out of range!");
+        }
+        _sourceFileColumnTypes.push_back(_inFileColumnTypes[fileColumn]);
+        if (!_inFileHeader.empty()) {
+            _sourceFileHeader.push_back(_inFileHeader.at(fileColumn));
+        }
+    }
+}
+
+void CsvHandler::setFieldValue(CsvEntryElement* field, _dataTypes dt,
+        const CsvStringSlice& entrySlice, long long entryIndex,
+        _errorHandlingMode errorHandlingMode) {
+    switch (dt) {
+        case type_double:
+        {
+            double value;
+            _parseStatus status = CsvFieldParser::parseDouble(
+                    entrySlice.begin(), entrySlice.end(), value);
+            if (status == parse_ok) {
+                setSingleEntryElementValue<double>(field, value);
+            } else if (errorHandlingMode == ignore_errors) {
+                setSingleEntryElementValue<double>(field, 0.0);
+                field->notSet();
+            } else {
+                throwConversionError(dt, status, entrySlice, entryIndex);
+            }
+            break;
+        }
+        case type_int:
+        {
+            int value;
+            _parseStatus status = CsvFieldParser::parseInt(
+                    entrySlice.begin(), entrySlice.end(), value);
+            if (status == parse_ok) {
+                setSingleEntryElementValue<int>(field, value);
+            } else if (errorHandlingMode == ignore_errors) {
+                setSingleEntryElementValue<int>(field, 0);
+                field->notSet();
+            } else {
+                throwConversionError(dt, status, entrySlice, entryIndex);
+            }
+            break;
+        }
+        case type_int64:
+        {
+            long long value;
+            _parseStatus status = CsvFieldParser::parseInt64(
+                    entrySlice.begin(), entrySlice.end(), value);
+            if (status == parse_ok) {
+                setSingleEntryElementValue<long long>(field, value);
+            } else if (errorHandlingMode == ignore_errors) {
+                setSingleEntryElementValue<long long>(field, 0);
+                field->notSet();
+            } else {
+                throwConversionError(dt, status, entrySlice, entryIndex);
+            }
+            break;
+        }
+        case type_date:
+        {
+            std::time_t value;
+            _parseStatus status = _dateFormat.parse(
+                    entrySlice.begin(), entrySlice.end(), value);
+            if (status == parse_ok) {
+                setSingleEntryElementValue<std::time_t>(field, value);
+            } else if (errorHandlingMode == ignore_errors) {
+                setSingleEntryElementValue<std::time_t>(field, 0);
+                field->notSet();
+            } else {
+                throwConversionError(dt, status, entrySlice, entryIndex);
             }
+            break;
+        }
+        default:
+        {
+            setSingleEntryElementValue<std::string>(field,
+                    entrySlice.toString());
+            break;
         }
-        ++columnIndex;
     }
 }
 
+bool CsvHandler::setStoredValue(CsvColumnStore& store, long long row,
+        _dataTypes dt, const CsvStringSlice& entrySlice, long long entryIndex,
+        _errorHandlingMode errorHandlingMode) {
+    _parseStatus status;
+    switch (dt) {
+        case type_double:
+            status = CsvFieldParser::parseDouble(entrySlice.begin(),
+                    entrySlice.end(), store.values<double>()[row]);
+            if (status != parse_ok) store.values<double>()[row] = 0.0;
+            break;
+        case type_int:
+            status = CsvFieldParser::parseInt(entrySlice.begin(),
+                    entrySlice.end(), store.values<int>()[row]);
+            if (status != parse_ok) store.values<int>()[row] = 0;
+            break;
+        case type_int64:
+            status = CsvFieldParser::parseInt64(entrySlice.begin(),
+                    entrySlice.end(), store.values<long long>()[row]);
+            if (status != parse_ok) store.values<long long>()[row] = 0;
+            break;
+        default:
+            status = _dateFormat.parse(entrySlice.begin(), entrySlice.end(),
+                    store.values<CsvDate>()[row]);
+            if (status != parse_ok) store.values<CsvDate>()[row] = 0;
+            break;
+    }
+    if (status != parse_ok && errorHandlingMode != ignore_errors) {
+        throwConversionError(dt, status, entrySlice, entryIndex);
+    }
+    return status == parse_ok;
+}
+
 void CsvHandler::printParsingErrorMessage(const std::string& type, int col, int entry) {
     std::cerr << "ERROR: Cannot parse value to " << type << "."
             << " Will leave column: " << col
@@ -652,84 +2063,40 @@ void CsvHandler::setSingleEntryElementValue(
     } else {
         auto* tn = new csv_stringField();
         tn->setValue(_zeroChar);
-        delete toBeSetted;
+        _heapElements.insert(tn);
+        deleteEntryElement(toBeSetted);
         toBeSetted = tn;
     }
 }
 
 void CsvHandler::splitEntryByDelimiter(std::string& lineToSplit,
         csv_entryLine & splittedLine, char delimiter) {
-    int poss = 0;
-    int pose = 0;
-
-    while ((poss <= (int) lineToSplit.length()) && (pose != -1)) {
-        if (poss == (int) lineToSplit.length()) {
-            splittedLine.emplace_back(_emptyString);
-            pose = -1;
-        } else {
-            poss = lineToSplit.find_first_not_of(_whitespace, poss);
-            if (poss == -1) {
-                splittedLine.emplace_back(_emptyString);
-                pose = -1;
-            } else if (lineToSplit[poss] == _quotationMark) {
-                pose = getDoubleQuottedFieldEnding(lineToSplit, poss, delimiter);
-                emplaceSpacesFreeFieldInVector(lineToSplit,
-                        splittedLine, poss, pose);
-            } else {
-                pose = lineToSplit.find_first_of(delimiter, poss);
-                emplaceSpacesFreeFieldInVector(lineToSplit,
-                        splittedLine, poss, pose);
-            }
-            poss = pose + 1;
-        }
+    csv_entrySlices splittedSlices;
+    splitEntryByDelimiter(CsvStringSlice(lineToSplit), splittedSlices, delimiter);
+    for (const CsvStringSlice& field : splittedSlices) {
+        splittedLine.emplace_back(field.toString());
     }
 }
 
-void CsvHandler::emplaceSpacesFreeFieldInVector(std::string& lineToSplit,
-        csv_entryLine& splittedLine, int& poss, int& pose) {
-    if (pose == -1) {
-        int correctedPose = pose;
-        if (lineToSplit[lineToSplit.length() - 1] == _space
-                || lineToSplit[lineToSplit.length() - 1] == _tab) {
-            int notSpaceFromLast =
-                    lineToSplit.find_last_not_of(_whitespace, lineToSplit.length());
-            correctedPose =
-                    lineToSplit.find_first_not_of(_whitespace, notSpaceFromLast) + 1;
-        }
-        splittedLine.emplace_back(lineToSplit.substr(poss, correctedPose - poss));
+void CsvHandler::splitEntryByDelimiter(const CsvStringSlice& lineToSplit,
+        csv_entrySlices & splittedLine, char delimiter) {
+    if (delimiter == _csvDelimiter) {
+        _scanner.splitFields(lineToSplit, splittedLine);
     } else {
-        int correctedPose = pose;
-        if ((lineToSplit[pose - 1] == _space || lineToSplit[pose - 1] == _tab)
-                && pose - poss > 1) {
-            int notSpaceFromLast =
-                    lineToSplit.find_last_not_of(_whitespace, pose - 1);
-            correctedPose =
-                    lineToSplit.find_first_not_of(_whitespace, notSpaceFromLast) + 1;
-        }
-        splittedLine.emplace_back(lineToSplit.substr(poss, correctedPose - poss));
-    }
-}
-
-int CsvHandler::getDoubleQuottedFieldEnding(std::string& lineToSplit, int poss,
-        char delimiter) {
-    unsigned int nqMarks = 1;
-    unsigned int posc = poss + 1;
-    while (posc < lineToSplit.size() &&
-            ((nqMarks % 2) || lineToSplit[posc] != delimiter)) {
-        if (lineToSplit[posc] == _quotationMark) {
-            ++nqMarks;
-        }
-        ++posc;
+        CsvStructuralScanner(delimiter).splitFields(lineToSplit, splittedLine);
     }
-    return posc;
 }
 
 void CsvHandler::printDataOnScreen() {
+    parseAllColumns();
     if (!_sourceFileVector.empty()) {
+        std::stringstream field;
         for (int currEntry = 0; currEntry < _entriesInCurrentChunk; ++currEntry) {
+            if (_removedRows.isRemoved(currEntry)) continue;
             for (int currCol = 0; currCol < (int) _sourceFileColumnTypes.size(); ++currCol) {
-                std::cout << "|" << std::setw(15)
-                        << _sourceFileVector[currCol][currEntry]->getStringValue();
+                field.str(_emptyString);
+                writeField(field, currCol, currEntry);
+                std::cout << "|" << std::setw(15) << field.str();
             }
             std::cout << "|" << std::endl;
         }
@@ -760,6 +2127,11 @@ void CsvHandler::printHeaderOnScreen() {
 
 void CsvHandler::storeDataInFile(const std::string& newCsvFileName,
         _fileFormat outFormat, char delimiter) {
+    if (outFormat == JSON) {
+        materializeAllColumns();
+    } else {
+        parseAllColumns();
+    }
     if (!_sourceFileVector.empty()) {
         if (outFormat == CSV) {
             storeHeaderInFile_CSV(newCsvFileName, delimiter, std::ios::ate | std::ios::binary);
@@ -798,18 +2170,16 @@ void CsvHandler::storeHeaderInFile_CSV(const std::string& newCsvFileName,
 void CsvHandler::storeFieldsInFile_CSV(const std::string& newCsvFileName,
         char delimiter, std::ios::openmode openMode) {
     std::ofstream file(newCsvFileName, openMode);
+    int amountOfColumns = _sourceFileColumnTypes.size();
     for (int currEntry = 0; currEntry < _entriesInCurrentChunk; ++currEntry) {
-        if (_sourceFileVector.front().at(currEntry)->isSet()) {
-            file << _sourceFileVector.front().at(currEntry)->getStringValue();
+        if (_removedRows.isRemoved(currEntry)) continue;
+        if (isFieldSet(0, currEntry)) {
+            writeField(file, 0, currEntry);
         }
-        for (std::vector<std::vector < CsvEntryElement*>>::iterator columnIt =
-                _sourceFileVector.begin() + 1;
-                columnIt < _sourceFileVector.end(); ++columnIt) {
+        for (int currCol = 1; currCol < amountOfColumns; ++currCol) {
             file << delimiter;
-            if ((*columnIt).at(currEntry)->isSet()) {
-                file << (*columnIt).at(currEntry)->getStringValue();
-            } else {
-                file << "";
+            if (isFieldSet(currCol, currEntry)) {
+                writeField(file, currCol, currEntry);
             }
         }
         if (_CRLF == true) file << _CR;
@@ -827,7 +2197,11 @@ void CsvHandler::storeFieldsInFile_JSON(const std::string& newCsvFileName,
 
     std::ofstream file(newCsvFileName, openMode);
     if (_chunksCount == 1) file << _leftSquare;
+    bool firstEntry = true;
     for (int cEntry = 0; cEntry < _entriesInCurrentChunk; ++cEntry) {
+        if (_removedRows.isRemoved(cEntry)) continue;
+        if (!firstEntry) file << _comma;
+        firstEntry = false;
         if (_CRLF == true) file << _CR;
         file << _inFileLineEnding << _leftBrace;
         if (_CRLF == true) file << _CR;
@@ -843,7 +2217,6 @@ void CsvHandler::storeFieldsInFile_JSON(const std::string& newCsvFileName,
             file << _inFileLineEnding;
         }
         file << _rightBrace;
-        if (cEntry < _entriesInCurrentChunk - 1) file << _comma;
     }
 
     if (_eofFlag) {
@@ -853,43 +2226,8 @@ void CsvHandler::storeFieldsInFile_JSON(const std::string& newCsvFileName,
     file.close();
 }
 
-void CsvHandler::initializeNewEntry(int newEntryPos) {
-    csv_entryLine::iterator typeIt = _sourceFileColumnTypes.begin();
-
-    for (int columnId = 0; columnId < (int) _sourceFileColumnTypes.size(); ++columnId) {
-        _dataTypes dataColumnType = _dataTypesMap[*typeIt];
-
-        switch (dataColumnType) {
-            case type_double:
-                _sourceFileVector[columnId].insert(
-                        _sourceFileVector[columnId].begin() + newEntryPos,
-                        new csv_doubleField);
-                break;
-            case type_int:
-                _sourceFileVector[columnId].insert(
-                        _sourceFileVector[columnId].begin() + newEntryPos,
-                        new csv_intField);
-                break;
-            default:
-                _sourceFileVector[columnId].insert(
-                        _sourceFileVector[columnId].begin() + newEntryPos,
-                        new csv_stringField);
-
-                break;
-        }
-        ++typeIt;
-    }
-}
-
 std::vector<CsvEntryElement*> CsvHandler::initializeNewColumn(_dataTypes type) {
-    switch (type) {
-        case type_double:
-            return initializeEntriesForColumn<csv_doubleField>();
-        case type_int:
-            return initializeEntriesForColumn<csv_intField>();
-        default:
-            return initializeEntriesForColumn<csv_stringField>();
-    }
+    return initializeEntriesForColumn(type);
 }
 
 std::string CsvHandler::getDataTypeAsString(_dataTypes dataType) {
@@ -902,18 +2240,16 @@ std::string CsvHandler::getDataTypeAsString(_dataTypes dataType) {
 }
 
 void CsvHandler::surroundStringFieldsWithQuotationMarks() {
-    int currentColumnId = 0;
-
-    for (std::vector<CsvEntryElement*> columnV : _sourceFileVector) {
-        if (isColumnStringType(currentColumnId)) {
-            surroundFieldsInVectorWithQuotationMarks(columnV);
+    for (int columnId = 0; columnId < (int) _sourceFileVector.size(); ++columnId) {
+        if (isColumnStringType(columnId)) {
+            materializeColumn(columnId);
+            surroundFieldsInVectorWithQuotationMarks(_sourceFileVector[columnId]);
         }
-        currentColumnId++;
     }
 }
 
 void CsvHandler::surroundFieldsInVectorWithQuotationMarks(
-        std::vector<CsvEntryElement*>& vect) {
+        csv_blockedColumn& vect) {
     for (auto field : vect) {
         csv_stringField* typedField =
                 dynamic_cast<csv_stringField*> (field);
@@ -955,7 +2291,8 @@ inline std::string CsvHandler::addQuotationMarks(const std::string & field) {
 csv_genericField CsvHandler::getField(int columnIndex, int rowIndex) {
     if (rowIndex >= _absoluteBeginningIndex && rowIndex < _absoluteEndingIndex
             && columnIndex < (int) _sourceFileColumnTypes.size()) {
-        long long row = _entriesInCurrentChunk - (_absoluteEndingIndex - rowIndex);
+        long long row = findChunkRow(rowIndex);
+        materializeColumn(columnIndex);
         return _sourceFileVector[columnIndex][row];
     } else if (_eofFlag && rowIndex >= _absoluteEndingIndex) {
         throw std::out_of_range("Row or column index is out of range!");
@@ -980,25 +2317,37 @@ csv_genericField CsvHandler::getField(std::string columnCaption, int rowIndex) {
 }
 
 csv_entryLine CsvHandler::getRow(int rowIndex) {
-    csv_entryLine entry;
-
     if (rowIndex >= _absoluteBeginningIndex && rowIndex < _absoluteEndingIndex) {
-        long long row = _entriesInCurrentChunk - (_absoluteEndingIndex - rowIndex);
-        entry.reserve(_sourceFileColumnTypes.size());
-        for (int colID = 0; colID < (int) _sourceFileColumnTypes.size(); ++colID) {
-            entry.emplace_back(_sourceFileVector[colID][row]->getStringValue());
-        }
-        return entry;
+        parseAllColumns();
+        return getChunkRow(findChunkRow(rowIndex));
     } else if (_eofFlag && rowIndex >= _absoluteEndingIndex) {
         throw std::out_of_range("Row index out of range!");
     }
+    return csv_entryLine();
+}
+
+csv_entryLine CsvHandler::getChunkRow(long long row) {
+    csv_entryLine entry;
+    entry.reserve(_sourceFileColumnTypes.size());
+    std::stringstream field;
+    for (int colID = 0; colID < (int) _sourceFileColumnTypes.size(); ++colID) {
+        field.str(_emptyString);
+        writeField(field, colID, row);
+        entry.emplace_back(field.str());
+    }
     return entry;
 }
 
+long long CsvHandler::findChunkRow(long long rowIndex) {
+    return _removedRows.findRow(
+            getAmountOfEntries() - (_absoluteEndingIndex - rowIndex));
+}
+
 csv_column CsvHandler::getColumn(int columnIndex) {
     if (columnIndex < (int) _sourceFileColumnTypes.size()) {
-
-        return _sourceFileVector[columnIndex];
+        compactRows();
+        materializeColumn(columnIndex);
+        return _sourceFileVector[columnIndex].toVector();
     }
     throw std::out_of_range("Column index is out of range!");
 }
@@ -1012,7 +2361,9 @@ std::vector<CsvEntryElement*> CsvHandler::getColumn(std::string columnCaption) {
         std::string msg = "Column caption " + columnCaption + " is not valid.";
         throw InvalidColumnCaptionException(msg.c_str());
     }
-    return _sourceFileVector[colID];
+    compactRows();
+    materializeColumn(colID);
+    return _sourceFileVector[colID].toVector();
 }
 
 int CsvHandler::getColumnId(std::string columnCaption) {
@@ -1028,12 +2379,13 @@ int CsvHandler::getColumnId(std::string columnCaption) {
 }
 
 void CsvHandler::removeColumn(int columnIndex) {
+    materializeAllColumns();
     _sourceFileColumnTypes.erase(_sourceFileColumnTypes.begin() + columnIndex);
     if (!_sourceFileHeader.empty()) {
         _sourceFileHeader.erase(_sourceFileHeader.begin() + columnIndex);
     }
-    for (auto it = _sourceFileVector[columnIndex].begin(); it < _sourceFileVector[columnIndex].end(); it++) {
-        delete *it;
+    for (CsvEntryElement* field : _sourceFileVector[columnIndex]) {
+        deleteEntryElement(field);
     }
     _sourceFileVector.erase(_sourceFileVector.begin() + columnIndex);
 }
@@ -1052,34 +2404,182 @@ void CsvHandler::removeColumn(std::string columnCaption) {
 }
 
 void CsvHandler::removeRow(int rowIndex) {
-    long long pos = rowIndex;
     if (rowIndex >= _absoluteBeginningIndex && rowIndex < _absoluteEndingIndex) {
-        pos = _entriesInCurrentChunk - (_absoluteEndingIndex - rowIndex);
-        for (int colID = 0; colID < (int) _sourceFileColumnTypes.size(); ++colID) {
-            delete _sourceFileVector[colID].at(pos);
-            _sourceFileVector[colID].erase(_sourceFileVector[colID].begin() + pos);
+        long long row = findChunkRow(rowIndex);
+        if (_removedRows.size() != _entriesInCurrentChunk) {
+            _removedRows.reset(_entriesInCurrentChunk);
         }
-        _entriesInCurrentChunk--;
+        _removedRows.remove(row);
         _absoluteEndingIndex--;
-    } else if (_eofFlag && pos > _absoluteEndingIndex) {
+        if (_removedRows.countRemoved()
+                > _compactionThreshold * _removedRows.size()) {
+            compactRows();
+        }
+    } else if (_eofFlag && rowIndex > _absoluteEndingIndex) {
         throw std::out_of_range("Row index out of range!");
     }
 }
 
+long long CsvHandler::removeRows(const csv_rowPredicate& predicate) {
+    parseAllColumns();
+    if (_removedRows.size() != _entriesInCurrentChunk) {
+        _removedRows.reset(_entriesInCurrentChunk);
+    }
+    long long removed = 0;
+    for (long long row = 0; row < _entriesInCurrentChunk; ++row) {
+        if (!_removedRows.isRemoved(row) && predicate(getChunkRow(row))) {
+            _removedRows.remove(row);
+            ++removed;
+        }
+    }
+    _absoluteEndingIndex -= removed;
+    if (_removedRows.countRemoved()
+            > _compactionThreshold * _removedRows.size()) {
+        compactRows();
+    }
+    return removed;
+}
+
+long long CsvHandler::removeRows(const std::vector<int>& columns,
+        const csv_rowCallback& predicate) {
+    std::vector<_dataTypes> types;
+    for (int columnIndex : columns) {
+        if (columnIndex < 0 || columnIndex >= (int) _sourceFileColumnTypes.size()) {
+            throw std::out_of_range("Column index is out of range!");
+        }
+        types.push_back(_dataTypesMap.at(_sourceFileColumnTypes[columnIndex]));
+    }
+    if (_removedRows.size() != _entriesInCurrentChunk) {
+        _removedRows.reset(_entriesInCurrentChunk);
+    }
+    std::vector<CsvStringSlice> fields(columns.size());
+    std::vector<CsvRowValue> values(columns.size());
+    std::vector<std::string> texts(columns.size());
+    long long rowIndex = _absoluteEndingIndex - getAmountOfEntries();
+    long long removed = 0;
+    for (long long row = 0; row < _entriesInCurrentChunk; ++row) {
+        if (_removedRows.isRemoved(row)) continue;
+        for (unsigned int field = 0; field < columns.size(); ++field) {
+            readRowViewField(columns[field], types[field], row, fields[field],
+                    values[field], texts[field]);
+        }
+        if (predicate(CsvRowView(fields, values, rowIndex++, &_dateFormat))) {
+            // Counted at once, rows removed before exception stay removed.
+            _removedRows.remove(row);
+            --_absoluteEndingIndex;
+            ++removed;
+        }
+    }
+    if (_removedRows.countRemoved()
+            > _compactionThreshold * _removedRows.size()) {
+        compactRows();
+    }
+    return removed;
+}
+
+void CsvHandler::readRowViewField(int columnIndex, _dataTypes type, long long row,
+        CsvStringSlice& field, CsvRowValue& value, std::string& text) {
+    value.kind = CsvRowValue::value_text;
+    value.buffer.clear();
+    if (_columnStates.empty() || _columnStates[columnIndex] == column_elements) {
+        text = _sourceFileVector[columnIndex][row]->getStringValue();
+        field = CsvStringSlice(text);
+        return;
+    }
+    if (_columnStates[columnIndex] == column_on_tape) {
+        field = getTapeField(row, columnIndex);
+        return;
+    }
+    const CsvColumnStore& store = _columnStores[columnIndex];
+    value.set = store.isSet(row);
+    switch (type) {
+        case type_int:
+        case type_int64:
+            value.kind = CsvRowValue::value_integer;
+            value.integer = store.getInteger(row);
+            break;
+        case type_double:
+            value.kind = CsvRowValue::value_double;
+            value.real = store.value<double>(row);
+            break;
+        case type_date:
+            value.kind = CsvRowValue::value_date;
+            value.integer = store.value<CsvDate>(row);
+            break;
+        default:
+            field = store.getString(row);
+            break;
+    }
+}
+
+void CsvHandler::compactRows() {
+    if (_removedRows.countRemoved() == 0) return;
+    // Columns left on the tape are not parsed, removed rows are dropped
+    // from the mapping of entries to tape rows instead.
+    if (std::find(_columnStates.begin(), _columnStates.end(), column_on_tape)
+            != _columnStates.end()) {
+        std::vector<long long> entryRows;
+        entryRows.reserve(_removedRows.countLeft());
+        for (long long entry = 0; entry < _entriesInCurrentChunk; ++entry) {
+            if (_removedRows.isRemoved(entry)) continue;
+            entryRows.push_back(_entryRows.empty() ? entry : _entryRows[entry]);
+        }
+        _entryRows.swap(entryRows);
+    }
+    unsigned int threads = countParserThreads(
+            _entriesInCurrentChunk * _sourceFileColumnTypes.size(),
+            _minEntriesPerParserThread);
+    threads = std::min((unsigned long) threads, _sourceFileColumnTypes.size());
+    // Elements passed by user are unregistered when deleted.
+    if (!_heapElements.empty()) threads = 1;
+    runInParallel(threads, _sourceFileColumnTypes.size(),
+            [this](unsigned int, long long columnBegin, long long columnEnd) {
+                for (long long colID = columnBegin; colID < columnEnd; ++colID) {
+                    if (!_columnStates.empty()
+                            && _columnStates[colID] == column_on_tape) {
+                        continue;
+                    }
+                    if (!_columnStates.empty()
+                            && _columnStates[colID] == column_stored) {
+                        _columnStores[colID].removeRows(_removedRows);
+                        continue;
+                    }
+                    csv_blockedColumn& column = _sourceFileVector[colID];
+                    csv_blockedColumn keptFields;
+                    long long row = 0;
+                    for (CsvEntryElement* field : column) {
+                        if (_removedRows.isRemoved(row++)) {
+                            deleteEntryElement(field);
+                        } else {
+                            keptFields.push_back(field);
+                        }
+                    }
+                    column.swap(keptFields);
+                }
+            });
+    _entriesInCurrentChunk = _removedRows.countLeft();
+    _removedRows.clear();
+}
+
+void CsvHandler::setCompactionThreshold(double removedFraction) {
+    _compactionThreshold = removedFraction;
+}
+
 void CsvHandler::insertRow(csv_entryLine entry, int pos,
         _errorHandlingMode errorHandlingMode) {
-    int newEntryPos = pos;
+    compactRows();
+    long long newEntryPos = pos;
 
     if (pos == -1 && _eofFlag) {
         newEntryPos = _entriesInCurrentChunk;
-        initializeNewEntry(newEntryPos);
-        setColumnsForEntry(entry, newEntryPos, errorHandlingMode);
+        insertEntry(entry, newEntryPos, errorHandlingMode);
         ++_entriesInCurrentChunk;
         ++_absoluteEndingIndex;
     } else if (pos >= _absoluteBeginningIndex && pos < _absoluteEndingIndex) {
-        newEntryPos = _entriesInCurrentChunk - _absoluteEndingIndex - pos;
-        initializeNewEntry(newEntryPos);
-        setColumnsForEntry(entry, newEntryPos, errorHandlingMode);
+        // Rows are compacted, so entries from pos to the end of file
+        // loaded so far are the last entries of the chunk.
+        newEntryPos = _entriesInCurrentChunk - (_absoluteEndingIndex - pos);
+        insertEntry(entry, newEntryPos, errorHandlingMode);
         ++_entriesInCurrentChunk;
         ++_absoluteEndingIndex;
     } else if (_eofFlag && pos > _absoluteEndingIndex) {
@@ -1103,7 +2603,14 @@ void CsvHandler::insertColumn(std::vector<CsvEntryElement*>& columnVector,
     } else if (pos > (int) _sourceFileColumnTypes.size()) {
         throw std::out_of_range("Provided pos is greater than amount of columns");
     }
-    _sourceFileVector.insert(_sourceFileVector.begin() + newColPos, columnVector);
+    prepareColumnInsertion();
+    if (!_columnStates.empty()) {
+        _columnStates.insert(_columnStates.begin() + newColPos, column_elements);
+        _columnStores.insert(_columnStores.begin() + newColPos, CsvColumnStore());
+    }
+    _sourceFileVector.insert(_sourceFileVector.begin() + newColPos,
+            csv_blockedColumn(columnVector.begin(), columnVector.end()));
+    _heapElements.insert(columnVector.begin(), columnVector.end());
     _sourceFileColumnTypes.insert(_sourceFileColumnTypes.begin() + newColPos,
             getDataTypeAsString(type));
 }
@@ -1130,10 +2637,41 @@ void CsvHandler::insertColumn(_dataTypes type, int pos) {
     if (pos == -1) {
         newColPos = _sourceFileColumnTypes.size();
     }
+    prepareColumnInsertion();
     _sourceFileColumnTypes.insert(_sourceFileColumnTypes.begin() + newColPos,
             getDataTypeAsString(type));
+    if (_columnStates.empty()) {
+        csv_column newColumn = initializeNewColumn(type);
+        _sourceFileVector.insert(_sourceFileVector.begin() + newColPos,
+                csv_blockedColumn(newColumn.begin(), newColumn.end()));
+        return;
+    }
+    // Fields of new column are not set, so they are kept in storage
+    // without creating elements.
+    CsvColumnStore store;
+    if (type == type_string) {
+        store.assignStrings(_entriesInCurrentChunk);
+        store.allocateStrings();
+    } else if (type == type_int) {
+        store.assign<int>(_entriesInCurrentChunk);
+    } else if (type == type_int64) {
+        store.assign<long long>(_entriesInCurrentChunk);
+    } else if (type == type_double) {
+        store.assign<double>(_entriesInCurrentChunk);
+    } else {
+        store.assign<CsvDate>(_entriesInCurrentChunk);
+    }
+    store.notSetAll();
+    _columnStates.insert(_columnStates.begin() + newColPos, column_stored);
+    _columnStores.insert(_columnStores.begin() + newColPos, store);
     _sourceFileVector.insert(_sourceFileVector.begin() + newColPos,
-            initializeNewColumn(type));
+            csv_blockedColumn());
+}
+
+void CsvHandler::prepareColumnInsertion() {
+    compactRows();
+    // Tape fields are found by column index, which changes.
+    parseAllColumns();
 }
 
 void CsvHandler::insertColumn(const std::string& caption,
@@ -1157,10 +2695,35 @@ long long CsvHandler::replaceAll(int columnPos,
         std::string regex, std::string replacement) {
     if (columnPos < (int) _sourceFileColumnTypes.size()
             && _sourceFileColumnTypes.at(columnPos) == _tString) {
+        parseColumn(columnPos);
         std::regex r(regex);
-        std::smatch matches;
         long long replaced = 0;
-        for (CsvEntryElement* field : _sourceFileVector.at(columnPos)) {
+        if (isDictionaryColumn(columnPos)) {
+            CsvColumnStore& store = _columnStores[columnPos];
+            std::vector<int> matchCounts = countDictionaryMatches(columnPos, r);
+            std::vector<long long> codeCounts(matchCounts.size(), 0);
+            for (long long row = 0; row < store.size(); ++row) {
+                if (!_removedRows.isRemoved(row)) ++codeCounts[store.getCode(row)];
+            }
+
+            std::vector<std::string> values;
+            values.reserve(matchCounts.size());
+            for (unsigned long code = 0; code < matchCounts.size(); ++code) {
+                values.emplace_back(store.getDictionaryValue(code).toString());
+                if (matchCounts[code] > 0) {
+                    values.back() = std::regex_replace(values.back(), r, replacement);
+                    replaced += matchCounts[code] * codeCounts[code];
+                }
+            }
+            store.setDictionaryValues(values);
+            return replaced;
+        }
+        materializeColumn(columnPos);
+        std::smatch matches;
+        csv_blockedColumn& column = _sourceFileVector.at(columnPos);
+        for (long long row = 0; row < column.size(); ++row) {
+            if (_removedRows.isRemoved(row)) continue;
+            CsvEntryElement* field = column[row];
             std::string s = field->getStringValue();
             std::regex_search(s, matches, r);
             for (std::string ms : matches) {
@@ -1184,10 +2747,33 @@ long long CsvHandler::replaceAll(std::string columnCaption,
 
 csv_column CsvHandler::findAll(int columnPos, std::string regex) {
     if (columnPos < (int) _sourceFileColumnTypes.size()) {
+        parseColumn(columnPos);
         csv_column fFields;
         std::regex r(regex);
+        if (isDictionaryColumn(columnPos)) {
+            const CsvColumnStore& store = _columnStores[columnPos];
+            std::vector<int> matchCounts = countDictionaryMatches(columnPos, r);
+            std::vector<CsvEntryElement*> codeFields(matchCounts.size(), nullptr);
+            for (long long row = 0; row < store.size(); ++row) {
+                uint32_t code = store.getCode(row);
+                if (matchCounts[code] == 0 || _removedRows.isRemoved(row)
+                        || !store.isSet(row)) continue;
+                if (codeFields[code] == nullptr) {
+                    csv_stringField* field = _elementArenas[0].create<csv_stringField>();
+                    field->setValue(store.getDictionaryValue(code).toString());
+                    _dictionaryFieldViews.push_back(field);
+                    codeFields[code] = field;
+                }
+                fFields.insert(fFields.end(), matchCounts[code], codeFields[code]);
+            }
+            return fFields;
+        }
+        materializeColumn(columnPos);
         std::smatch matches;
-        for (CsvEntryElement* field : _sourceFileVector.at(columnPos)) {
+        csv_blockedColumn& column = _sourceFileVector.at(columnPos);
+        for (long long row = 0; row < column.size(); ++row) {
+            if (_removedRows.isRemoved(row)) continue;
+            CsvEntryElement* field = column[row];
             std::string s = field->getStringValue();
             std::regex_search(s, matches, r);
             for (std::string ms : matches) {
@@ -1208,19 +2794,34 @@ csv_column CsvHandler::findAll(std::string columnCaption, std::string regex) {
 
 csv_entryLines CsvHandler::findAllRows(int columnPos, std::string regex) {
     if (columnPos < (int) _sourceFileColumnTypes.size()) {
+        parseColumn(columnPos);
         csv_entryLines rows;
         std::regex r(regex);
+        if (isDictionaryColumn(columnPos)) {
+            std::vector<int> matchCounts = countDictionaryMatches(columnPos, r);
+            const CsvColumnStore& store = _columnStores[columnPos];
+            parseAllColumns();
+            for (long long row = 0; row < store.size(); ++row) {
+                if (_removedRows.isRemoved(row)) continue;
+                for (int match = 0; match < matchCounts[store.getCode(row)]; ++match) {
+                    rows.push_back(getChunkRow(row));
+                }
+            }
+            return rows;
+        }
+        materializeColumn(columnPos);
+        parseAllColumns();
         std::smatch matches;
-        long long rowIndex = 0;
-        for (CsvEntryElement* field : _sourceFileVector.at(columnPos)) {
-            std::string s = field->getStringValue();
+        csv_blockedColumn& column = _sourceFileVector.at(columnPos);
+        for (long long row = 0; row < column.size(); ++row) {
+            if (_removedRows.isRemoved(row)) continue;
+            std::string s = column[row]->getStringValue();
             std::regex_search(s, matches, r);
             for (std::string ms : matches) {
                 if (!ms.empty()) {
-                    rows.push_back(getRow(rowIndex));
+                    rows.push_back(getChunkRow(row));
                 }
             }
-            ++rowIndex;
         }
         return rows;
     } else {
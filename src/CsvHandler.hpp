@@ -9,9 +9,27 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <unordered_set>
 #include <iomanip>
+#include <functional>
+#include <regex>
 #include "CsvEntryElement.hpp"
 #include "CsvHandlerExceptions.hpp"
+#include "CsvStringSlice.hpp"
+#include "CsvRowView.hpp"
+#include "CsvStructuralScanner.hpp"
+#include "CsvFieldParser.hpp"
+#include "CsvDateFormat.hpp"
+#include "CsvMappedFile.hpp"
+#include "CsvChunkReader.hpp"
+#include "CsvDataSource.hpp"
+#include "CsvDecompressingSource.hpp"
+#include "CsvColumnStore.hpp"
+#include "CsvArena.hpp"
+#include "CsvRowTombstones.hpp"
+#include "CsvBlockedVector.hpp"
+#include "CsvRejectSink.hpp"
+#include "CsvMemoryUsage.hpp"
 
 namespace csvh {
 
@@ -19,10 +37,17 @@ namespace csvh {
     typedef CsvTypedEntryElement<std::string> csv_stringField;
     typedef CsvTypedEntryElement<double> csv_doubleField;
     typedef CsvTypedEntryElement<int> csv_intField;
+    typedef CsvTypedEntryElement<long long> csv_int64Field;
     typedef CsvTypedEntryElement<std::time_t> csv_timeField;
+    typedef CsvDateEntryElement csv_dateField;
     typedef std::vector<CsvEntryElement*> csv_column;
+    typedef CsvBlockedVector<CsvEntryElement*> csv_blockedColumn;
     typedef CsvEntryElement* csv_genericField;
     typedef std::vector<csv_entryLine> csv_entryLines;
+    typedef std::vector<CsvStringSlice> csv_entrySlices;
+    typedef std::function<bool(const CsvRowView&)> csv_rowCallback;
+    typedef std::function<bool(const csv_entryLine&)> csv_rowPredicate;
+    typedef std::function<void(unsigned int, long long, long long)> csv_rangeTask;
     /**
      * Enum to represent column data type.
      */
@@ -30,7 +55,8 @@ namespace csvh {
         type_double,
         type_int,
         type_string,
-        type_date
+        type_date,
+        type_int64
     };
 
     enum _headerMode {
@@ -46,7 +72,8 @@ namespace csvh {
 
     enum _loadDataMode {
         load_in_chunks,
-        load_whole_file
+        load_whole_file,
+        load_mmap
     };
 
     enum _fileFormat {
@@ -54,14 +81,47 @@ namespace csvh {
         JSON
     };
 
+    enum _chunkSizingMode {
+        fixed_chunk_size,
+        chunk_by_memory_budget,
+        chunk_by_rows
+    };
+
+    /**
+     * Enum to represent rows used for column type detection.
+     */
+    enum _typeSampleMode {
+        sample_first_rows,
+        sample_spread
+    };
+
+    /**
+     * Enum to represent comparison used by row filters.
+     */
+    enum _comparisonOperator {
+        op_equal,
+        op_not_equal,
+        op_less,
+        op_less_equal,
+        op_greater,
+        op_greater_equal
+    };
+
     class CsvHandler {
     public:
 
         /**
          * Main constructor for initializing CSV Handler library.
+         * gzip and zstd compressed files are detected and decompressed
+         * while reading, load_mmap falls back to load_whole_file for them.
+         * Every loadEntries call in load_whole_file mode decompresses
+         * such file again from the beginning.
          *
          * @param fileName - data source
-         * @param loadDataMode - by default load_whole_file into memory
+         * @param loadDataMode - by default load_whole_file into memory.
+         *        load_mmap maps the file instead of copying it into a buffer,
+         *        CSV fields are tokenized straight from mapped pages while
+         *        JSON entries are still copied out of the mapping
          * @param fileFormat - CSV / JSON
          * @param delimiter - default delimiter is ','
          * @param headerMode - by default no_header
@@ -72,6 +132,62 @@ namespace csvh {
                 char delimiter = ',',
                 _headerMode headerMode = no_header);
 
+        /**
+         * Constructor for reading data from any sequential source, e.g.
+         * pipe or standard input. Source is read once, without seeks.
+         * load_mmap is not available for sources, load_whole_file is used
+         * instead. load_whole_file can be loaded again only if source
+         * can be rewound.
+         *
+         * @param dataSource - owned and deleted by the handler
+         * @param loadDataMode - by default load_in_chunks
+         * @param fileFormat - CSV / JSON
+         * @param delimiter - default delimiter is ','
+         * @param headerMode - by default no_header
+         */
+        CsvHandler(CsvDataSource* dataSource,
+                _loadDataMode loadDataMode = load_in_chunks,
+                _fileFormat fileFormat = CSV,
+                char delimiter = ',',
+                _headerMode headerMode = no_header);
+
+        /**
+         * Constructor for reading data from std::istream.
+         * Stream is not owned and has to outlive the handler.
+         *
+         * @param inStream - e.g. std::cin
+         * @param loadDataMode - by default load_in_chunks
+         * @param fileFormat - CSV / JSON
+         * @param delimiter - default delimiter is ','
+         * @param headerMode - by default no_header
+         */
+        CsvHandler(std::istream& inStream,
+                _loadDataMode loadDataMode = load_in_chunks,
+                _fileFormat fileFormat = CSV,
+                char delimiter = ',',
+                _headerMode headerMode = no_header);
+
+        /**
+         * Constructor for reading file in chunks sized adaptively.
+         * Chunk size is estimated from the first lines of the file and
+         * corrected after every chunk using measured bytes per row and
+         * memory used by loaded fields.
+         *
+         * @param fileName - data source
+         * @param chunkSizingMode - chunk_by_memory_budget / chunk_by_rows
+         * @param chunkSizingLimit - memory budget in bytes for read buffers
+         *        and loaded chunk, or target number of rows per chunk
+         * @param fileFormat - CSV / JSON
+         * @param delimiter - default delimiter is ','
+         * @param headerMode - by default no_header
+         */
+        CsvHandler(const std::string& inFileName,
+                _chunkSizingMode chunkSizingMode,
+                long long chunkSizingLimit,
+                _fileFormat fileFormat = CSV,
+                char delimiter = ',',
+                _headerMode headerMode = no_header);
+
         ~CsvHandler();
 
         /**
@@ -122,6 +238,7 @@ namespace csvh {
          * Available types are:
          * - type_double
          * - type_int
+         * - type_int64
          * - type_string
          * - type_date
          *
@@ -135,6 +252,7 @@ namespace csvh {
          * Available types are:
          * - type_double
          * - type_int
+         * - type_int64
          * - type_string
          * - type_date
          *
@@ -143,6 +261,91 @@ namespace csvh {
          */
         void provideTypesForColumns(unsigned int amountOfColumns, _dataTypes * dataTypes);
 
+        /**
+         * Method is used to set rows used for automatic detection of
+         * column types. Column type is widened int -> int64 -> double ->
+         * string when sampled fields differ, date columns become string
+         * when mixed with other types. Empty fields are skipped. Columns
+         * are inspected in parallel by parser threads. By default the first
+         * 1024 entries are sampled. Has to be called before loadEntries.
+         *
+         * @param sampleRows - amount of sampled entries
+         * @param sampleMode - sample_first_rows or sample_spread to take
+         *        rows from evenly spaced offsets of the file (uncompressed
+         *        files only, otherwise first rows are used)
+         */
+        void setTypeDetectionSample(long long sampleRows,
+                _typeSampleMode sampleMode = sample_first_rows);
+
+        /**
+         * Method is used to select columns loaded by loadEntries.
+         * Fields of other columns are skipped by the parser, no storage
+         * is allocated for them. Selected columns are numbered
+         * from 0 in the given order. Has to be called before loadEntries.
+         *
+         * @param columnIndexes - indexes of columns in the file,
+         *        empty to load all columns
+         */
+        void selectColumns(const std::vector<int>& columnIndexes);
+
+        /**
+         * Method is used to select columns loaded by loadEntries
+         * by header captions. Captions are resolved when entries are
+         * loaded, throws InvalidColumnCaptionException if caption is
+         * not in the header.
+         *
+         * @param columnCaptions
+         */
+        void selectColumns(const std::vector<std::string>& columnCaptions);
+
+        /**
+         * Method is used to add filter applied while entries are loaded.
+         * Entry is stored only when it matches all filters. Filtered column
+         * is converted to its type right after tokenizing, other columns
+         * are converted only for matching entries. Field which cannot be
+         * converted does not match. Columns are numbered as in the file,
+         * also when selectColumns is used.
+         *
+         * @param columnIndex
+         * @param comparison
+         * @param value - compared with int, double and date (epoch seconds)
+         *        fields, string fields are converted to double
+         */
+        void addRowFilter(int columnIndex, _comparisonOperator comparison,
+                double value);
+        void addRowFilter(const std::string& columnCaption,
+                _comparisonOperator comparison, double value);
+
+        /**
+         * Method is used to add filter comparing field with text.
+         * For int, double and date columns value is converted
+         * to the column type once, string fields are compared as text.
+         *
+         * @param columnIndex
+         * @param comparison
+         * @param value
+         */
+        void addRowFilter(int columnIndex, _comparisonOperator comparison,
+                const std::string& value);
+        void addRowFilter(const std::string& columnCaption,
+                _comparisonOperator comparison, const std::string& value);
+
+        /**
+         * Method is used to add filter keeping entries whose field
+         * contains a match of regular expression.
+         *
+         * @param columnIndex
+         * @param regex
+         */
+        void addRegexFilter(int columnIndex, const std::string& regex);
+        void addRegexFilter(const std::string& columnCaption,
+                const std::string& regex);
+
+        /**
+         * Method is used to remove all row filters.
+         */
+        void clearRowFilters();
+
         /**
          * Method is used to validate if provided data types
          * for columns are correct.
@@ -187,6 +390,126 @@ namespace csvh {
         bool loadEntries(_errorHandlingMode errorHandlingMode =
                 stop_on_error);
 
+        /**
+         * Method is used to visit all entries of the file without loading
+         * them into storage. File is read in chunks and every entry is split
+         * into a reused vector of slices, so memory usage does not depend
+         * on file size. Loaded data is not changed.
+         * Source is read from the beginning, so for non seekable sources
+         * it has to be called before loadEntries. In load_in_chunks mode
+         * loadEntries returns false afterwards.
+         *
+         * @param callback - called for every entry, returning false stops
+         *        reading
+         * @param errorHandlingMode - by default entry with wrong number
+         *        of fields stops reading, with ignore_errors it is skipped
+         * @return number of visited entries
+         */
+        long long forEachRow(const csv_rowCallback& callback,
+                _errorHandlingMode errorHandlingMode = stop_on_error);
+
+        /**
+         * Method is used to enable read-ahead in load_in_chunks mode.
+         * Next chunk of the file is read by a background thread while
+         * the current one is parsed. Has to be called before the first
+         * loadEntries call.
+         *
+         * @param readAhead
+         */
+        void enableReadAhead(bool readAhead = true);
+
+        /**
+         * Method is used to set destination of entry lines rejected in
+         * ignore_errors mode. By default first 100 lines are written to
+         * std::cerr and later ones are only counted.
+         * Sink is not owned and has to outlive loading.
+         *
+         * @param rejectSink - nullptr discards rejected lines
+         */
+        void setRejectSink(CsvRejectSink* rejectSink);
+
+        /**
+         * Method is used to enable lazy parsing of columns. Loaded entries
+         * are only tokenized, every column is converted to its type the
+         * first time it is accessed (getColumn, getField, getRow, etc.),
+         * so unused columns cost neither memory nor conversion time.
+         * With stop_on_error conversion errors are thrown on access.
+         *
+         * @param lazyParsing
+         */
+        void enableLazyParsing(bool lazyParsing = true);
+
+        /**
+         * Method is used to enable dictionary encoding of string columns.
+         * Column with at most one distinct value per 16 rows keeps every
+         * value once and a code per row, and findAll, findAllRows and
+         * replaceAll match regex once per distinct value.
+         * Enabled by default.
+         *
+         * @param dictionaryEncoding
+         */
+        void enableDictionaryEncoding(bool dictionaryEncoding = true);
+
+        /**
+         * Method is used to enable narrowing of loaded type_int and
+         * type_int64 columns, e.g. column of flags takes one byte per row.
+         * getIntColumn and getInt64Column widen the column back.
+         * Enabled by default.
+         *
+         * @param integerNarrowing
+         */
+        void enableIntegerNarrowing(bool integerNarrowing = true);
+
+        /**
+         * Method is used to set number of threads parsing loaded chunk.
+         * Chunk is split at entry boundaries into segments parsed and
+         * converted by separate threads, rows keep their order.
+         * Small chunks are parsed by a single thread. By default 1.
+         *
+         * @param threads - 0 to use all hardware threads
+         */
+        void setParserThreads(unsigned int threads = 0);
+
+        /**
+         * Method is used to set format of type_date columns. Dates are
+         * read as local time, stored as seconds since epoch and written
+         * back in the same format. By default "%Y-%m-%d %H:%M:%S".
+         *
+         * @param dateFormat - strptime-like format
+         */
+        void setDateFormat(const std::string& dateFormat);
+
+        /**
+         * Method returns how long loadEntries was blocked waiting for
+         * file data since the handler was created.
+         *
+         * @return wait time in microseconds
+         */
+        long long getIoWaitTime();
+
+        /**
+         * Method returns memory allocated by the handler, per category and
+         * per column of current chunk. Computed from allocated capacities,
+         * text of string columns kept as CsvEntryElement objects is
+         * measured on a sample of rows.
+         *
+         * @return memory usage
+         */
+        CsvMemoryUsage getMemoryUsage();
+
+        /**
+         * Method is used to set hard limit of memory used by loaded data.
+         * In load_in_chunks mode chunks are shrunk to fit the limit.
+         * loadEntries throws MemoryLimitExceededException instead of
+         * loading entries when file read at once or mapped is larger than
+         * the limit, or when getMemoryUsage exceeds it after converting
+         * the chunk. Pages of the mapped file count towards the limit in
+         * load_mmap mode. Storage is released before throwing.
+         *
+         * @param memoryLimit - bytes, 0 disables the limit
+         */
+        void setMemoryLimit(long long memoryLimit);
+
         /**
          * Method is used to fetch selected field from csv file.
          *
@@ -230,6 +553,33 @@ namespace csvh {
          */
         std::vector<CsvEntryElement*> getColumn(std::string columnCaption);
 
+        /**
+         * Methods return values of loaded column kept in contiguous memory.
+         * Column fields are not CsvEntryElement objects then, so element
+         * pointers of the column fetched earlier become invalid.
+         * Accessing column by element API afterwards creates them again.
+         * Row groups of the column split by inserted rows are merged.
+         * Throws UnableToConvertFieldTypeException when column has
+         * different type and std::out_of_range for invalid column index.
+         *
+         * @param columnIndex
+         * @return span valid until column is modified or next chunk is loaded
+         */
+        CsvColumnSpan<int> getIntColumn(int columnIndex);
+        CsvColumnSpan<long long> getInt64Column(int columnIndex);
+        CsvColumnSpan<double> getDoubleColumn(int columnIndex);
+        CsvColumnSpan<std::time_t> getDateColumn(int columnIndex);
+
+        /**
+         * Method returns contiguous storage of loaded column, e.g. to read
+         * string fields or to check fields left unset by ignore_errors.
+         * The same rules as for getIntColumn apply.
+         *
+         * @param columnIndex
+         * @return column storage
+         */
+        const CsvColumnStore& getColumnStore(int columnIndex);
+
         /**
          * Method is used to get column ID by caption
          *
@@ -253,16 +603,64 @@ namespace csvh {
         void removeColumn(std::string columnCaption);
 
         /**
-         * Method is used to remove row.
+         * Method is used to remove row. Row is only marked as removed
+         * and skipped by getRow, getField, findAll, findAllRows,
+         * replaceAll, printDataOnScreen and storeDataInFile. Rows are
+         * dropped from columns by compactRows.
          *
          * @param rowIndex
          */
         void removeRow(int rowIndex);
 
+        /**
+         * Method is used to remove all rows of current chunk accepted
+         * by predicate, in one pass over the chunk. All columns are
+         * converted and formatted, the overload taking columns reads
+         * only the fields it is given.
+         *
+         * @param predicate - gets fields as returned by getRow
+         * @return number of removed rows
+         */
+        long long removeRows(const csv_rowPredicate& predicate);
+
+        /**
+         * Method is used to remove all rows of current chunk accepted
+         * by predicate, which gets only given columns, field i of the view
+         * is of column columns[i]. Columns left on the tape by lazy parsing
+         * are not converted, the view parses their text when it is read.
+         * Values of converted columns are read by typed accessors
+         * without formatting them.
+         * Throws std::out_of_range for invalid column index.
+         *
+         * @param columns - indexes of columns read by predicate
+         * @param predicate
+         * @return number of removed rows
+         */
+        long long removeRows(const std::vector<int>& columns,
+                const csv_rowCallback& predicate);
+
+        /**
+         * Method is used to drop removed rows from all columns at once.
+         * It is called when fraction of removed rows exceeds compaction
+         * threshold and before columns are returned or rows inserted.
+         * Columns not parsed yet stay on the tape.
+         */
+        void compactRows();
+
+        /**
+         * Method is used to set fraction of removed rows of the chunk
+         * which triggers compactRows. Default is 0.25.
+         *
+         * @param removedFraction - 0 compacts after every removal
+         */
+        void setCompactionThreshold(double removedFraction);
+
         /**
          * Method is used to instert row on selected position.
          * By default row will be added at the end.
-         * Data conversion will be done automatically.
+         * Data conversion will be done automatically. Columns kept in
+         * typed arrays get the value in the array, without creating
+         * field objects. Entry with wrong field changes no column.
          *
          * @param entry as vector of strings
          * @param pos - position where row should be added. By default the last.
@@ -363,6 +761,9 @@ namespace csvh {
 
         /**
          * Method is used to find all fields matching regular expression.
+         * Dictionary encoded column stays encoded: rows with the same
+         * value share one returned field, which is not a part of column
+         * storage and is valid until the next loadEntries.
          *
          * @param columnPos
          * @param regex - regular expression
@@ -408,6 +809,16 @@ namespace csvh {
         void splitEntryByDelimiter(std::string& lineToSplit,
                 csv_entryLine & splittedLine, char delimiter);
 
+        /**
+         * Method is used to split line by delimiter without copying fields.
+         * Resulting slices reference bytes of lineToSplit.
+         *
+         * @param lineToSplit
+         * @param splittedLine
+         */
+        void splitEntryByDelimiter(const CsvStringSlice& lineToSplit,
+                csv_entrySlices & splittedLine, char delimiter);
+
         /**
          * Method returns number of currently loaded entries.
          *
@@ -435,7 +846,6 @@ namespace csvh {
         _headerMode _headerModeFlag;
         _loadDataMode _loadDataModeFlag;
         _fileFormat _inFileFormatFlag;
-        size_t sizeType;
         //======================================================================
 
         // ========== Properities used for chunk file read =====================
@@ -445,7 +855,7 @@ namespace csvh {
         bool _eofFlag;
 
         /**
-         * Stream size for whole file.
+         * Stream size for whole file, -1 if source size is not known.
          */
         long long _inFileStreamSize;
 
@@ -454,6 +864,25 @@ namespace csvh {
          */
         long _inFileReadLastPosition;
 
+        /**
+         * Position in file of the beginning of current chunk.
+         */
+        long long _chunkByteOffset;
+
+        /**
+         * Amount of entry lines, header included, read before
+         * current chunk and number of the first entry line of the chunk.
+         */
+        long long _linesRead;
+        long long _chunkFirstLine;
+
+        /**
+         * Destination of rejected entry lines, _defaultRejectLog
+         * unless set by setRejectSink.
+         */
+        CsvRejectSink* _rejectSink;
+        CsvRejectLog _defaultRejectLog = CsvRejectLog(std::cerr);
+
         /**
          * Number of line starting the current chunk.
          */
@@ -481,182 +910,720 @@ namespace csvh {
          */
         long long _readBufferSize = 1024 * 1024 * 32;
 
-        // =====================================================================
-
-
-        // ========== JSON handling ============================================
-
-        const int _jsonProperty = 0;
-        const int _jsonValue = 1;
+        /**
+         * Lower limit for adaptively sized chunks.
+         */
+        const long long _minReadBufferSize = 1024 * 64;
 
-        // =====================================================================
+        /**
+         * How chunk size is chosen, see _chunkSizingMode.
+         */
+        _chunkSizingMode _chunkSizingModeFlag;
 
         /**
-         * Storage for source file data
+         * Memory budget in bytes or number of rows per chunk.
          */
-        std::vector<std::vector < CsvEntryElement*>> _sourceFileVector;
-        std::vector<std::string> _sourceFileHeader;
-        std::vector<std::string> _sourceFileColumnTypes;
+        long long _chunkSizingLimit;
 
         /**
-         * Const values used in text parsing.
+         * Hard memory limit in bytes, 0 when not set.
          */
-        const char* _emptyString = "";
-        const char* _zeroChar = "0";
-        const char* _whitespace = " \t";
-        const char _quotationMark = '"';
-        const char _space = ' ';
-        const char _tab = '\t';
-        const char _CR = '\r';
-        const char _LF = '\n';
-        bool _CRLF;
+        long long _memoryLimit;
 
         /**
-         * For JSON
+         * Memory of fields, column storage and tapes of the last loaded
+         * chunk, measured by checkMemoryLimit for adjustReadBufferSize.
          */
-        const char _rightBrace = '}';
-        const char _leftBrace = '{';
-        const char _rightSquare = ']';
-        const char _leftSquare = '[';
-        const char _comma = ',';
-        const char _colon = ':';
-        const char* _tabSpaces = "    ";
+        long long _chunkStorageMemory;
 
         /**
-         * Const values used in type checks.
+         * Fraction of the memory limit planned for a chunk, the rest is
+         * left for capacity of growing vectors.
          */
-        const std::string _tString = "type_string";
-        const std::string _tDouble = "type_double";
-        const std::string _tInt = "type_int";
-        const std::string _tDate = "type_date";
-        const char* _defaultDTFormat = "%Y-%m-%d %H:%M:%S";
+        const double _memoryLimitFill = 0.75;
 
         /**
-         * std::map used to map data types strings to enum
+         * Number of rows used to measure memory of loaded string fields
+         * and number of probe lines used for the first estimation.
          */
-        std::map<std::string, _dataTypes> _dataTypesMap;
+        const long long _memorySampleRows = 1024;
 
         /**
-         * Method is used to initialize object variables with default values.
+         * Type detection sample, see setTypeDetectionSample.
          */
-        void classInitializer();
+        long long _typeSampleRows;
+        _typeSampleMode _typeSampleModeFlag;
 
         /**
-         * Methods are used to clear all created field objects.
+         * Amount of file positions used by sample_spread.
          */
-        void clearStorage();
-        void clearHeader();
-        void clearDataTypes();
+        const unsigned int _typeSampleWindows = 16;
 
         /**
-         * Method is used to fetch the numer of entries in csv file.
-         *
-         * @return numer of entries.
+         * Approximate bookkeeping overhead of a single heap allocation.
          */
-        int fetchNumberOfCSVEntries();
+        const long long _heapAllocationOverhead = 16;
 
         /**
-         * Method is used to fetch entry containing data types
-         * for whole columns.
-         *
-         * @return std::vector containing data types for columns as std::string
+         * Mapping of the input file used in load_mmap mode.
          */
-        csv_entryLine fetchDataTypesForColumns();
+        CsvMappedFile* _mappedFile;
 
         /**
-         * Method is used to automatic fetch of data type for all columns.
+         * Source of input data.
          */
-        void autoDetectTypesForColumns();
+        CsvDataSource* _dataSource;
 
         /**
-         * Method is used to automatic fetch of data type for all columns
-         * from provided reference line
-         *
-         * @param firstLineElements
+         * Reader used in load_in_chunks and load_whole_file modes.
          */
-        void autoDetectTypesForColumns(csv_entryLine& referenceLine);
+        CsvChunkReader* _chunkReader;
 
         /**
-         * Method is used to fetch streamsize of source file
-         *
-         * @return streamsize
+         * Flag is set when chunks should be read in a background thread.
          */
-        long long fetchFileStreamSize();
+        bool _readAheadFlag;
 
-        std::vector<std::string> convertCharBufferIntoCSVentryStrings(
-                std::vector<char> partialData);
-        std::vector<std::string> convertCharBufferIntoJSONentryStrings(
-                std::vector<char> partialData);
         /**
-         * Method is used to parse first line of CSV file as a header.
+         * Flag is set when columns are converted on first access.
          */
-        bool loadHeader(std::string & line);
-        bool loadHeader(std::vector<std::string> entryLine);
+        bool _lazyParsingFlag;
+
         /**
-         * Method is used to get next chunk of entries specified by:
-         * const size_t _readBufferSize
+         * Flag is set when string columns can be dictionary encoded.
          */
-        void loadChunkOfFile(std::vector<char>& data);
+        bool _dictionaryEncodingFlag;
 
-        void loadEntries_CSV(std::vector<char>& data,
-                _errorHandlingMode errMode);
+        /**
+         * Flag is set when integer columns are stored with the smallest width.
+         */
+        bool _integerNarrowingFlag;
 
-        void loadEntries_JSON(std::vector<char>& data,
-                _errorHandlingMode errMode);
+        /**
+         * Minimal amount of rows per distinct value of encoded column.
+         */
+        const long long _dictionaryRowsPerValue = 16;
 
         /**
-         * Method is used to prepare storage for holding source file in memory.
+         * Representation of a loaded column.
          */
-        void initializeStorage();
+        enum _columnState {
+            column_on_tape,
+            column_stored,
+            column_elements
+        };
 
         /**
-         * Method is used to initialize column vector for given columnId.
-         *
-         * @return std::vector containig initialized column.
+         * State of columns of current chunk, empty when all columns are
+         * kept as CsvEntryElement objects in _sourceFileVector.
          */
-        template<class T >
-        std::vector<CsvEntryElement*> initializeEntriesForColumn();
+        std::vector<_columnState> _columnStates;
 
         /**
-         * Method is used to initialize storage for new row.
-         *
-         * @param newEntryPos
+         * Contiguous storage of column_stored columns.
          */
-        void initializeNewEntry(int newEntryPos);
+        std::vector<CsvColumnStore> _columnStores;
 
         /**
-         * Method is used to initialize storage for new column.
-         *
-         * @param type
+         * Memory of CsvEntryElement objects created by the handler, one
+         * arena per parser thread. Released at once by clearStorage.
          */
-        std::vector<CsvEntryElement*> initializeNewColumn(_dataTypes type);
+        std::vector<CsvArena> _elementArenas;
 
         /**
-         * Method is used to initialize storage for new column.
-         *
-         * @param type
-         * @param newEntryPos
-         * @param caption
+         * Elements passed by user, e.g. with insertColumn. They are
+         * allocated with new, all other elements come from _elementArenas.
          */
-        void initializeNewColumn(_dataTypes type, int newColumnPos,
-                const std::string & caption);
+        std::unordered_set<CsvEntryElement*> _heapElements;
 
         /**
-         * Method is used to determine line ending character.
-         *
-         * @return line ending character
+         * Fields returned by findAll for dictionary encoded columns, one
+         * per matching value. Allocated from the first arena.
          */
-        char determineLineEnding();
+        std::vector<CsvEntryElement*> _dictionaryFieldViews;
 
         /**
-         * Method is used to emplace entries in storage.
-         *
-         * @param entryLines
-         * @param fileFormat - CSV / JSON
-         * @param errorHandlingMode
+         * Rows of current chunk removed but not compacted yet.
+         * Empty when no row is removed.
          */
-        void emplaceEntriesInStorage(std::vector<std::string>& entryLines,
-                _fileFormat fileFormat, _errorHandlingMode errorHandlingMode);
+        CsvRowTombstones _removedRows;
+
+        /**
+         * Fraction of removed rows which triggers compaction.
+         */
+        double _compactionThreshold;
+
+        /**
+         * Error handling mode of the loadEntries call, used when
+         * lazy column is converted.
+         */
+        _errorHandlingMode _lazyErrorHandlingMode;
+
+        /**
+         * Index of the first entry of every tape in _fieldTapes.
+         */
+        std::vector<long long> _tapeFirstEntries;
+
+        /**
+         * Tape rows of stored entries, counted from the first tape.
+         * Empty when no entry was rejected or filtered out and no row
+         * was compacted while columns were left on the tape.
+         */
+        std::vector<long long> _entryRows;
+
+        /**
+         * Buffer holding chunk joined with leftovers of previous one.
+         * Kept as a member, because tapes reference it until next chunk.
+         */
+        std::vector<char> _stitchBuffer;
+
+        /**
+         * Indexes of file columns loaded into storage, empty when
+         * all columns are loaded.
+         */
+        std::vector<int> _selectedColumns;
+
+        /**
+         * Captions of selected columns, resolved into _selectedColumns
+         * when header is known.
+         */
+        std::vector<std::string> _selectedCaptions;
+
+        /**
+         * Enum to represent kind of row filter.
+         */
+        enum _filterKind {
+            filter_number,
+            filter_text,
+            filter_regex
+        };
+
+        /**
+         * Condition checked for every tokenized entry.
+         */
+        struct RowFilter {
+            _filterKind kind;
+            int columnIndex;
+            std::string columnCaption;
+            _comparisonOperator comparison;
+            double number;
+            std::string text;
+            std::regex pattern;
+            /**
+             * Set by prepareRowFilters for the loaded file.
+             */
+            _dataTypes columnType;
+            bool numericComparison;
+        };
+
+        std::vector<RowFilter> _rowFilters;
+
+        /**
+         * First bytes of the input file. Read once at construction time
+         * and used to detect line ending, header and column types.
+         */
+        std::string _probeBuffer;
+
+        /**
+         * Chunk size used by forEachRow when file is not read in chunks.
+         */
+        const long long _rowStreamChunkSize = 1024 * 1024 * 4;
+
+        /**
+         * Amount of bytes added to _probeBuffer by a single read.
+         */
+        const long long _probeReadSize = 1024 * 64;
+
+        /**
+         * Flag is set when whole source fits in _probeBuffer.
+         */
+        bool _probeEndOfData;
+
+        // =====================================================================
+
+        // ========== Parallel parsing =========================================
+
+        /**
+         * Number of threads parsing a chunk.
+         */
+        unsigned int _parserThreads;
+
+        /**
+         * Minimal work given to a single parser thread, smaller chunks
+         * are not worth starting threads.
+         */
+        const long long _minEntriesPerParserThread = 1024 * 16;
+        const long long _minBytesPerParserThread = 1024 * 1024;
+
+        // =====================================================================
+
+
+        // ========== JSON handling ============================================
+
+        const int _jsonProperty = 0;
+        const int _jsonValue = 1;
+
+        // =====================================================================
+
+        /**
+         * Storage for source file data, columns are kept in blocks
+         * so inserting rows in the middle does not shift whole columns.
+         */
+        std::vector<csv_blockedColumn> _sourceFileVector;
+        std::vector<std::string> _sourceFileHeader;
+        std::vector<std::string> _sourceFileColumnTypes;
+
+        /**
+         * Const values used in text parsing.
+         */
+        const char* _emptyString = "";
+        const char* _zeroChar = "0";
+        const char* _whitespace = " \t";
+        const char _quotationMark = '"';
+        const char _space = ' ';
+        const char _tab = '\t';
+        const char _CR = '\r';
+        const char _LF = '\n';
+        bool _CRLF;
+
+        /**
+         * Scanner for structural characters of input file delimiter.
+         */
+        CsvStructuralScanner _scanner;
+
+        /**
+         * Format of type_date columns, compiled once per format string.
+         */
+        CsvDateFormat _dateFormat;
+
+        /**
+         * Tokenized fields of the current chunk, one tape per parser thread.
+         * Tapes are reused, so their capacity is allocated once.
+         */
+        std::vector<CsvFieldTape> _fieldTapes;
+
+        /**
+         * For JSON
+         */
+        const char _rightBrace = '}';
+        const char _leftBrace = '{';
+        const char _rightSquare = ']';
+        const char _leftSquare = '[';
+        const char _comma = ',';
+        const char _colon = ':';
+        const char* _tabSpaces = "    ";
+
+        /**
+         * Const values used in type checks.
+         */
+        const std::string _tString = "type_string";
+        const std::string _tDouble = "type_double";
+        const std::string _tInt = "type_int";
+        const std::string _tInt64 = "type_int64";
+        const std::string _tDate = "type_date";
+        const char* _defaultDTFormat = "%Y-%m-%d %H:%M:%S";
+
+        /**
+         * std::map used to map data types strings to enum
+         */
+        std::map<std::string, _dataTypes> _dataTypesMap;
+
+        /**
+         * Method is used to initialize object variables with default values.
+         */
+        void classInitializer();
+
+        /**
+         * Method is used to set properties passed to constructors.
+         */
+        void propertiesInitializer(_loadDataMode loadDataMode,
+                _fileFormat fileFormat, char delimiter, _headerMode headerMode);
+
+        /**
+         * Method is used to probe input file in a single pass.
+         * Size is taken from source metadata, line ending and header are
+         * detected from the first bytes of the source.
+         */
+        void probeInputFile();
+
+        /**
+         * Method is used to append next bytes of the source to _probeBuffer.
+         *
+         * @return false if end of source was reached or reading started
+         */
+        bool extendProbeBuffer();
+
+        /**
+         * Method is used to compute chunk size from given row statistics
+         * and _chunkSizingLimit, capped to fit _memoryLimit.
+         *
+         * @param bytesPerRow - average size of a row in the file
+         * @param memoryPerRow - average memory used by a loaded row
+         * @return chunk size in bytes
+         */
+        long long computeReadBufferSize(double bytesPerRow, double memoryPerRow);
+
+        /**
+         * Method is used to compute chunk size whose read buffers, entry
+         * line slices and loaded fields fit into given memory budget.
+         *
+         * @param budget - bytes
+         * @param bytesPerRow - average size of a row in the file
+         * @param memoryPerRow - average memory used by a loaded row
+         * @return chunk size in bytes
+         */
+        double fitChunkSize(double budget, double bytesPerRow, double memoryPerRow);
+
+        /**
+         * Method is used to check if chunk size is computed from loaded
+         * rows, i.e. for adaptive chunk sizing or memory limit.
+         *
+         * @return true in load_in_chunks mode with adaptive sizing or limit
+         */
+        bool isReadBufferSizeAdaptive();
+
+        /**
+         * Method is used to estimate first chunk size from probe lines.
+         */
+        void estimateReadBufferSize();
+
+        /**
+         * Method is used to correct chunk size after chunk was loaded.
+         *
+         * @param chunkSize - amount of bytes parsed in loaded chunk
+         */
+        void adjustReadBufferSize(long long chunkSize);
+
+        /**
+         * Method is used to estimate memory used by a single loaded field.
+         *
+         * @param type
+         * @param fieldLength - length of field text
+         * @return size in bytes
+         */
+        long long estimateFieldMemory(_dataTypes type, long long fieldLength);
+
+        /**
+         * Method returns size of CsvEntryElement object of given type.
+         *
+         * @param type
+         * @return size in bytes
+         */
+        long long getElementSize(_dataTypes type);
+
+        /**
+         * Method is used to estimate heap memory used by text of
+         * std::string, short strings are stored inside the object.
+         *
+         * @param fieldLength - length of field text
+         * @return size in bytes
+         */
+        long long estimateStringPayload(long long fieldLength);
+
+        /**
+         * Method is used to measure memory of a single column for
+         * getMemoryUsage.
+         *
+         * @param columnIndex
+         * @param sampleStep - every sampleStep-th string element is measured
+         * @return column memory usage
+         */
+        CsvColumnMemoryUsage measureColumnMemory(unsigned int columnIndex,
+                long long sampleStep);
+
+        /**
+         * Method is used to measure memory of header or types vector.
+         *
+         * @param strings
+         * @return size in bytes
+         */
+        long long measureStringsMemory(const std::vector<std::string>& strings);
+
+        /**
+         * Method is used to measure loaded chunk once with getMemoryUsage,
+         * for _chunkStorageMemory and the memory limit. Throws
+         * MemoryLimitExceededException when usage, with the mapped file
+         * in load_mmap mode, exceeds _memoryLimit. Loaded chunk is
+         * released before throwing.
+         */
+        void checkMemoryLimit();
+
+        /**
+         * Method is used to fetch first complete lines of the file
+         * from _probeBuffer. Buffer is extended if needed.
+         * Returned slices are valid till the next extendProbeBuffer call.
+         *
+         * @param amountOfLines
+         * @return lines found in probe buffer, at most amountOfLines
+         */
+        csv_entrySlices fetchProbeLines(unsigned int amountOfLines);
+
+        /**
+         * Methods are used to clear all created field objects.
+         */
+        void clearStorage();
+        void clearHeader();
+        void clearDataTypes();
+
+        /**
+         * Method is used to fetch entry containing data types
+         * for whole columns.
+         *
+         * @return std::vector containing data types for columns as std::string
+         */
+        csv_entryLine fetchDataTypesForColumns();
+
+        /**
+         * Method is used to automatic fetch of data type for all columns.
+         */
+        void autoDetectTypesForColumns();
+
+        /**
+         * Method is used to automatic fetch of data type for all columns
+         * from provided reference line
+         *
+         * @param firstLineElements
+         */
+        void autoDetectTypesForColumns(csv_entryLine& referenceLine);
+
+        /**
+         * Method is used to fetch streamsize of source file from
+         * file metadata, without reading the file.
+         *
+         * @return streamsize, -1 if not known
+         */
+        long long fetchFileStreamSize();
+
+        /**
+         * Method is used to tokenize buffer into _fieldTapes.
+         * Fields are not copied, tapes reference the buffer.
+         * Unfinished last line is kept in _buffLeftovers.
+         *
+         * @param data
+         * @param size
+         * @return amount of entries on tapes
+         */
+        long long tokenizeCharBuffer(const char* data, long long size);
+
+        /**
+         * Method is used to build _fieldTapes from JSON entries.
+         *
+         * @param entryLines
+         */
+        void tokenizeJSONentries(const std::vector<std::string>& entryLines);
+        std::vector<std::string> convertCharBufferIntoJSONentryStrings(
+                const char* data, long long size);
+        /**
+         * Method is used to parse first line of CSV file as a header.
+         */
+        bool loadHeader(const CsvStringSlice & line);
+        bool loadHeader(std::vector<std::string> entryLine);
+        /**
+         * Method is used to get next chunk of entries specified by:
+         * const size_t _readBufferSize
+         * Unfinished entry from the previous chunk is placed in front of
+         * returned data, in stitchBuffer if it does not fit chunk headroom.
+         *
+         * @param stitchBuffer - has to outlive returned chunk
+         * @return chunk of the file
+         */
+        CsvChunk loadChunkOfFile(std::vector<char>& stitchBuffer);
+
+        /**
+         * Method is used to pass entries of a buffer to forEachRow callback.
+         * Unfinished last entry is kept in _buffLeftovers.
+         *
+         * @param data
+         * @param size
+         * @param lastChunk - buffer ends with the end of the file
+         * @param callback
+         * @param errMode
+         * @param rowIndex - index of the next entry, updated
+         * @param expectedColumns - 0 if taken from the first entry, updated
+         * @return false if callback stopped reading
+         */
+        bool visitEntries(const char* data, long long size, bool lastChunk,
+                const csv_rowCallback& callback, _errorHandlingMode errMode,
+                long long& rowIndex, unsigned long& expectedColumns);
+
+        /**
+         * Method is used to pass single entry to forEachRow callback.
+         *
+         * @param fields - split entry
+         * @param line - whole entry, used in error messages
+         * @param byteOffset - position of the line in file, -1 if not known
+         * @return false if callback stopped reading
+         */
+        bool visitEntry(const csv_entrySlices& fields, const CsvStringSlice& line,
+                long long byteOffset, const csv_rowCallback& callback,
+                _errorHandlingMode errMode, long long& rowIndex,
+                unsigned long& expectedColumns);
+
+        /**
+         * Method is used to pass rejected entry line to _rejectSink.
+         *
+         * @param line
+         * @param lineNumber
+         * @param byteOffset - -1 if not known
+         * @param amountOfFields
+         * @param expectedFields
+         */
+        void rejectEntry(const CsvStringSlice& line, long long lineNumber,
+                long long byteOffset, long long amountOfFields,
+                long long expectedFields);
+
+        void loadEntries_CSV(const char* data, long long size,
+                _errorHandlingMode errMode);
+
+        void loadEntries_JSON(const char* data, long long size,
+                _errorHandlingMode errMode);
+
+        /**
+         * Method is used to prepare storage for holding source file in memory.
+         */
+        void initializeStorage();
+
+        /**
+         * Method is used to choose number of parser threads for given work.
+         *
+         * @param amountOfWork - entries or bytes
+         * @param minWorkPerThread
+         * @return number of threads, at least 1
+         */
+        unsigned int countParserThreads(long long amountOfWork,
+                long long minWorkPerThread);
+
+        /**
+         * Method is used to run task for consecutive ranges of work, each
+         * range in its own thread. Single range is run in calling thread.
+         * Exception thrown for the first failed range is rethrown after
+         * all threads finished.
+         *
+         * @param threads - number of ranges
+         * @param amountOfWork
+         * @param task - called with range index, begin and end
+         */
+        void runInParallel(unsigned int threads, long long amountOfWork,
+                const csv_rangeTask& task);
+
+        /**
+         * Method is used to initialize column vector for given columnId.
+         *
+         * @param type
+         * @return std::vector containig initialized column.
+         */
+        std::vector<CsvEntryElement*> initializeEntriesForColumn(_dataTypes type);
+
+        /**
+         * Method is used to create empty field of given type.
+         * Field is allocated from _elementArenas, so it has to be
+         * released with deleteEntryElement.
+         *
+         * @param type
+         * @param arenaId - parser thread creating the field
+         * @return new field
+         */
+        CsvEntryElement* newEntryElement(_dataTypes type,
+                unsigned int arenaId = 0);
+
+        /**
+         * Method is used to destroy field created by newEntryElement
+         * or passed by user, e.g. with insertColumn. Fields passed by user
+         * are removed from _heapElements, so it must not be called by
+         * parallel workers while _heapElements is not empty.
+         *
+         * @param field
+         */
+        void deleteEntryElement(CsvEntryElement* field);
+
+        /**
+         * Method is used to initialize storage for new column.
+         *
+         * @param type
+         */
+        std::vector<CsvEntryElement*> initializeNewColumn(_dataTypes type);
+
+        /**
+         * Method is used to initialize storage for new column.
+         *
+         * @param type
+         * @param newEntryPos
+         * @param caption
+         */
+        void initializeNewColumn(_dataTypes type, int newColumnPos,
+                const std::string & caption);
+
+        /**
+         * Method is used to determine line ending character
+         * from _probeBuffer.
+         *
+         * @return line ending character
+         */
+        char determineLineEnding();
+
+        /**
+         * Method is used to choose entries of _fieldTapes kept in storage.
+         * Entries with wrong number of fields are rejected, entries not
+         * matching row filters are skipped. Only filtered columns are
+         * converted here.
+         *
+         * @param errorHandlingMode
+         * @return amount of selected entries
+         */
+        long long selectEntries(_errorHandlingMode errorHandlingMode);
+
+        /**
+         * Method is used to choose entries of a single tape.
+         *
+         * @param tapeId
+         * @param errorHandlingMode
+         * @param rejectedEntries - entries with wrong number of fields
+         * @param skippedEntries - all entries left out of storage
+         */
+        void selectTapeEntries(unsigned int tapeId,
+                _errorHandlingMode errorHandlingMode,
+                std::vector<long long>& rejectedEntries,
+                std::vector<long long>& skippedEntries);
+
+        /**
+         * Method is used to resolve columns of row filters and convert
+         * compared values to column types.
+         */
+        void prepareRowFilters();
+
+        /**
+         * Method is used to check entry against all row filters.
+         *
+         * @param tape
+         * @param tapeRow
+         * @return true if entry should be stored
+         */
+        bool matchesRowFilters(const CsvFieldTape& tape, long long tapeRow);
+
+        /**
+         * Method is used to add row filter on column given by index
+         * or caption.
+         */
+        void addRowFilter(RowFilter& filter, int columnIndex,
+                const std::string& columnCaption);
+
+        /**
+         * Method is used to emplace selected entries in storage.
+         * Does nothing in lazy parsing mode.
+         *
+         * @param errorHandlingMode
+         */
+        void emplaceEntriesInStorage(_errorHandlingMode errorHandlingMode);
+
+        /**
+         * Method is used to find tape and row of stored entry.
+         *
+         * @param entryIndex - index in current chunk
+         * @param tapeId
+         * @param tapeRow
+         */
+        void locateTapeEntry(long long entryIndex, unsigned int& tapeId,
+                long long& tapeRow);
 
         /**
          * Method is used to parse JSON entry to entryLine
@@ -680,15 +1647,198 @@ namespace csvh {
                 std::string& jsonEntry, csv_entryLine& entryLine);
 
         /**
-         * Method is used to set values for whole entry.
+         * Method is used to insert entry passed by user. Columns kept
+         * as fields get new fields, other columns get the value in their
+         * storage. Throws UnableToConvertFieldTypeException before any
+         * column is changed.
+         *
+         * @param entry - values of storage columns
+         * @param entryIndex - position in current chunk
+         * @param errorHandlingMode
+         */
+        void insertEntry(const csv_entryLine& entry, long long entryIndex,
+                _errorHandlingMode errorHandlingMode);
+
+        /**
+         * Method is used to drop removed rows and convert columns kept on
+         * _fieldTapes before column is inserted.
+         */
+        void prepareColumnInsertion();
+
+        /**
+         * Method is used to set types and header of loaded columns,
+         * taking selected columns into account.
+         */
+        void applyColumnSelection();
+
+        /**
+         * Method returns file column of storage column.
+         *
+         * @param columnIndex
+         * @return index of column in the file
+         */
+        int getFileColumn(int columnIndex) {
+            return _selectedColumns.empty() ? columnIndex
+                    : _selectedColumns[columnIndex];
+        }
+
+        /**
+         * Method is used to convert field text and set it as field value.
          *
-         * @param entry - containing values for all columns
+         * @param field
+         * @param dt - type of the column
+         * @param entrySlice
          * @param entryIndex
          * @param errorHandlingMode
          */
-        void setColumnsForEntry(csv_entryLine entry, int entryIndex,
+        void setFieldValue(CsvEntryElement* field, _dataTypes dt,
+                const CsvStringSlice& entrySlice, long long entryIndex,
                 _errorHandlingMode errorHandlingMode);
 
+        /**
+         * Method is used to convert field text into column storage.
+         *
+         * @param store
+         * @param row - row of store which is set
+         * @param dt - type of the column, not type_string
+         * @param entrySlice
+         * @param entryIndex
+         * @param errorHandlingMode
+         * @return false when field was left unset
+         */
+        bool setStoredValue(CsvColumnStore& store, long long row,
+                _dataTypes dt, const CsvStringSlice& entrySlice,
+                long long entryIndex, _errorHandlingMode errorHandlingMode);
+
+        /**
+         * Method is used to convert column kept on _fieldTapes into
+         * contiguous column storage. Does nothing for converted columns.
+         *
+         * @param columnIndex
+         */
+        void parseColumn(int columnIndex);
+
+        /**
+         * Method is used to convert all columns kept on _fieldTapes.
+         * Called before tapes are invalidated.
+         */
+        void parseAllColumns();
+
+        /**
+         * Method is used to create CsvEntryElement objects of the column
+         * for element API. Column storage is released afterwards.
+         *
+         * @param columnIndex
+         */
+        void materializeColumn(int columnIndex);
+
+        /**
+         * Method is used to create CsvEntryElement objects of all columns.
+         * Called before storage is modified by element API.
+         */
+        void materializeAllColumns();
+
+        /**
+         * Method is used to move column back to contiguous storage.
+         * CsvEntryElement objects of the column are deleted.
+         *
+         * @param columnIndex
+         * @param type - expected type of the column
+         * @return column storage
+         */
+        CsvColumnStore& getStoredColumn(int columnIndex, _dataTypes type);
+
+        /**
+         * Method is used to copy values of column elements to its storage.
+         * Throws UnableToConvertFieldTypeException when element inserted
+         * by user is not of the column type. V is CsvDate for dates.
+         *
+         * @param columnIndex
+         * @param store - assigned for all rows of the column
+         */
+        template <class V>
+        void storeElementValues(int columnIndex, CsvColumnStore& store);
+
+        /**
+         * Method returns true for loaded column kept dictionary encoded.
+         *
+         * @param columnIndex
+         * @return true when column values are coded
+         */
+        bool isDictionaryColumn(int columnIndex);
+
+        /**
+         * Method is used to match regex against every distinct value
+         * of dictionary encoded column.
+         *
+         * @param columnIndex
+         * @param regex
+         * @return amount of non-empty matches for every code
+         */
+        std::vector<int> countDictionaryMatches(int columnIndex,
+                const std::regex& regex);
+
+        /**
+         * Method is used to write text of the field, as returned by
+         * CsvEntryElement::getStringValue, for column kept in any form
+         * except on _fieldTapes.
+         *
+         * @param out
+         * @param columnIndex
+         * @param row - index in current chunk
+         */
+        void writeField(std::ostream& out, int columnIndex, long long row);
+
+        /**
+         * Method is used to pass field to CsvRowView, as text slice
+         * for string columns, columns on _fieldTapes and elements,
+         * as converted value for other stored columns.
+         *
+         * @param columnIndex
+         * @param type - type of the column
+         * @param row - index in current chunk
+         * @param field - text of the field
+         * @param value - kind and value of the field
+         * @param text - buffer for text of element
+         */
+        void readRowViewField(int columnIndex, _dataTypes type, long long row,
+                CsvStringSlice& field, CsvRowValue& value, std::string& text);
+
+        /**
+         * Method returns text of all fields of the entry.
+         *
+         * @param row - index in current chunk
+         * @return entry
+         */
+        csv_entryLine getChunkRow(long long row);
+
+        /**
+         * Method returns index in current chunk of not removed entry.
+         *
+         * @param rowIndex - absolute index of the entry
+         * @return index in current chunk
+         */
+        long long findChunkRow(long long rowIndex);
+
+        /**
+         * Method returns false for field left unset by ignore_errors.
+         * Column can not be kept on _fieldTapes.
+         *
+         * @param columnIndex
+         * @param row - index in current chunk
+         * @return true when field has value
+         */
+        bool isFieldSet(int columnIndex, long long row);
+
+        /**
+         * Method is used to get field of entry kept on _fieldTapes.
+         *
+         * @param entryIndex - index in current chunk
+         * @param columnIndex
+         * @return field slice
+         */
+        CsvStringSlice getTapeField(long long entryIndex, int columnIndex);
+
         /**
          * Method is used to set value for single entry element.
          *
@@ -705,7 +1855,29 @@ namespace csvh {
          * @param value - to be parsed
          * @return recognized data type name as std::string
          */
-        std::string determineColumnType(const std::string & value);
+        _dataTypes determineColumnType(const CsvStringSlice & value);
+
+        /**
+         * Method is used to get type holding values of both types,
+         * following int -> int64 -> double -> string.
+         *
+         * @param columnType
+         * @param fieldType
+         * @return int and int64 give int64, integer and double give double,
+         *         other different types string
+         */
+        _dataTypes widenColumnType(_dataTypes columnType, _dataTypes fieldType);
+
+        /**
+         * Method is used to read sample lines from evenly spaced
+         * offsets of the input file, without the first window.
+         *
+         * @param linesPerWindow
+         * @param sampleText - text of sampled lines
+         * @param sampleLines - slices referencing sampleText are appended
+         */
+        void fetchSpreadSampleLines(long long linesPerWindow,
+                std::string& sampleText, csv_entrySlices& sampleLines);
 
         /**
          * Method is used to store header to file.
@@ -742,44 +1914,20 @@ namespace csvh {
          * @param vector
          */
         void surroundFieldsInVectorWithQuotationMarks(
-                std::vector<CsvEntryElement*>& vector);
+                csv_blockedColumn& vector);
 
         /**
-         * Method is used to determine ending of double quotted field.
+         * Method is used to throw UnableToConvertFieldTypeException
+         * for field which could not be converted. Message is built only
+         * when conversion failed.
          *
-         * @param lineToSplit
-         * @param poss - starting position of quotted field
-         * @param delimiter
-         * @return ending position of double quotted field
-         */
-        int getDoubleQuottedFieldEnding(std::string& lineToSplit, int poss,
-                char delimiter);
-
-        /**
-         * Method is used to emplace substring in provided vector
-         *
-         * @param lineToSplit
-         * @param splittedLine - place holder for result
-         * @param poss - starting position of the field
-         * @param pose - ending position of the field (delimiter)
-         */
-        void emplaceSpacesFreeFieldInVector(std::string& lineToSplit,
-                csv_entryLine& splittedLine, int& poss, int& pose);
-
-        /**
-         * Method is used to convert std::string to selected type.
-         * Type could be selected by template argument.
-         *
-         * Supported types: int, double
-         * Method throws invalid_argument exception while parsing
-         * is not possible.
-         *
-         * @param toBeParsed
+         * @param type - destination type of conversion
+         * @param status - result of CsvFieldParser
+         * @param field
          * @param entryIndex
-         * @return value of toBeParsed in selected type.
          */
-        template <class T >
-        T convertString(const std::string & toBeParsed, long long entryIndex);
+        void throwConversionError(_dataTypes type, _parseStatus status,
+                const CsvStringSlice& field, long long entryIndex);
 
         /**
          * Method is used to check if field is double quotted
@@ -31,3 +31,6 @@ const char UnableToSplitEntryException::_unableToSplitMsg[] =
 const char UnableToReadFileInChunks::_unableToReadInChunksMsg[] =
         "Unable to read file in chunks. File size is too small. Read whole file"
         " at once. Input file size is: ";
+
+const char MemoryLimitExceededException::_memoryLimitExceededMsg[] =
+        "Loading entries exceeds memory limit. Required/limit bytes: ";
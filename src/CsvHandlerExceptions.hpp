@@ -14,15 +14,17 @@
 #include <iostream>
 
 class InvalidColumnCaptionException : public std::exception {
-public:
+private:
+
+    std::string _msg;
 
-    const char* _msg;
+public:
 
     virtual const char * what() const throw () {
-        return _msg;
+        return _msg.c_str();
     }
 
-    InvalidColumnCaptionException(const char * msg) {
+    InvalidColumnCaptionException(const std::string& msg) {
         _msg = msg;
     }
 
@@ -48,6 +50,32 @@ public:
     }
 };
 
+class UnableToRewindSourceException : public std::exception {
+public:
+
+    virtual const char * what() const throw () {
+        return "Input source can not be read again. Use load_in_chunks mode"
+                " or a seekable source.";
+    }
+};
+
+class UnsupportedCompressionException : public std::exception {
+public:
+
+    virtual const char * what() const throw () {
+        return "Compression format is not supported by this build of the"
+                " library.";
+    }
+};
+
+class UnableToDecompressSourceException : public std::exception {
+public:
+
+    virtual const char * what() const throw () {
+        return "Compressed input is corrupted or truncated.";
+    }
+};
+
 class UnableToConvertFieldTypeException : public std::exception {
 private:
 
@@ -95,6 +123,15 @@ public:
         _msg += _unableToSplitMsg;
         _msg += ei.str();
     }
+
+    UnableToSplitEntryException(long long entryIndex, long long amountOfFields,
+            long long expectedFields) {
+        std::stringstream ei;
+        ei << entryIndex << " (expected " << expectedFields
+                << " fields, found " << amountOfFields << ")";
+        _msg += _unableToSplitMsg;
+        _msg += ei.str();
+    }
 };
 
 class UnableToReadFileInChunks : public std::exception {
@@ -117,6 +154,26 @@ public:
     }
 };
 
+class MemoryLimitExceededException : public std::exception {
+private:
+
+    std::string _msg;
+    static const char _memoryLimitExceededMsg[];
+
+public:
+
+    virtual const char * what() const throw () {
+        return _msg.c_str();
+    }
+
+    MemoryLimitExceededException(long long memoryUsage, long long memoryLimit) {
+        std::stringstream ml;
+        ml << memoryUsage << "/" << memoryLimit;
+        _msg += _memoryLimitExceededMsg;
+        _msg += ml.str();
+    }
+};
+
 class UserDefinedTypesValidationResult {
 private:
 
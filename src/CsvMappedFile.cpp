@@ -0,0 +1,107 @@
+/*
+ * File:   CsvMappedFile.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvMappedFile.hpp"
+#include "CsvHandlerExceptions.hpp"
+
+#if defined(_WIN32)
+#define CSVH_WIN32_MAPPING
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define CSVH_POSIX_MAPPING
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <fstream>
+#endif
+
+using namespace csvh;
+
+CsvMappedFile::CsvMappedFile(const std::string& fileName) {
+    _data = nullptr;
+    _size = 0;
+
+#if defined(CSVH_WIN32_MAPPING)
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw UnableToOpenFileException();
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw UnableToOpenFileException();
+    }
+    _size = fileSize.QuadPart;
+
+    if (_size > 0) {
+        // View keeps the mapping alive, both handles can be closed.
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        void* view = mapping != NULL ?
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (mapping != NULL) CloseHandle(mapping);
+        if (view == NULL) {
+            CloseHandle(file);
+            throw UnableToOpenFileException();
+        }
+        _data = static_cast<const char*> (view);
+    }
+    CloseHandle(file);
+#elif defined(CSVH_POSIX_MAPPING)
+    int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor == -1) {
+        throw UnableToOpenFileException();
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) == -1) {
+        close(fileDescriptor);
+        throw UnableToOpenFileException();
+    }
+    _size = fileStat.st_size;
+
+    if (_size > 0) {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE,
+                fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            close(fileDescriptor);
+            throw UnableToOpenFileException();
+        }
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*> (mapping);
+    }
+    // Mapping stays valid after its descriptor is closed.
+    close(fileDescriptor);
+#else
+    std::ifstream inFile(fileName.c_str(), std::ios::binary | std::ios::ate);
+    if (!inFile.is_open()) {
+        throw UnableToOpenFileException();
+    }
+    _size = inFile.tellg();
+    _content.resize(_size);
+    inFile.seekg(0);
+    if (_size > 0 && !inFile.read(&_content[0], _size)) {
+        throw UnableToOpenFileException();
+    }
+    _data = _size > 0 ? &_content[0] : nullptr;
+#endif
+}
+
+CsvMappedFile::~CsvMappedFile() {
+#if defined(CSVH_WIN32_MAPPING)
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+#elif defined(CSVH_POSIX_MAPPING)
+    if (_data != nullptr) {
+        munmap(const_cast<char*> (_data), _size);
+    }
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+ * File:   CsvMappedFile.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVMAPPEDFILE_HPP
+#define CSVMAPPEDFILE_HPP
+
+#include <string>
+#include <vector>
+
+namespace csvh {
+
+    /**
+     * Read-only memory mapping of the whole input file.
+     * Pages are loaded by the kernel on first access, so mapping does not
+     * copy file content into the process heap. Files are mapped with mmap
+     * on POSIX systems and MapViewOfFile on Windows; on other platforms
+     * file content is read into a buffer.
+     */
+    class CsvMappedFile {
+    public:
+
+        /**
+         * Maps provided file into memory.
+         * Throws UnableToOpenFileException if file can not be mapped.
+         *
+         * @param fileName
+         */
+        CsvMappedFile(const std::string& fileName);
+
+        ~CsvMappedFile();
+
+        /**
+         * @return pointer to the first byte of the file
+         */
+        const char* data() const {
+            return _data;
+        }
+
+        /**
+         * @return size of the mapped file in bytes
+         */
+        long long size() const {
+            return _size;
+        }
+
+    private:
+        const char* _data;
+        long long _size;
+
+        /**
+         * Copy of the file, used only where mapping is not available.
+         */
+        std::vector<char> _content;
+
+        CsvMappedFile(const CsvMappedFile&);
+        CsvMappedFile& operator=(const CsvMappedFile&);
+    };
+}
+
+#endif /* CSVMAPPEDFILE_HPP */
@@ -0,0 +1,89 @@
+/*
+ * File:   CsvMemoryUsage.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVMEMORYUSAGE_HPP
+#define CSVMEMORYUSAGE_HPP
+
+#include <vector>
+
+namespace csvh {
+
+    /**
+     * Memory allocated for a single loaded column, in bytes.
+     */
+    struct CsvColumnMemoryUsage {
+        /**
+         * CsvEntryElement objects of the column.
+         */
+        long long cellObjects;
+
+        /**
+         * Text of string fields, heap allocations of std::string included.
+         */
+        long long stringPayloads;
+
+        /**
+         * Allocated capacity of value, validity, offset, code and
+         * element pointer vectors.
+         */
+        long long vectorCapacity;
+
+        CsvColumnMemoryUsage()
+        : cellObjects(0), stringPayloads(0), vectorCapacity(0) {
+        }
+
+        long long getTotal() const {
+            return cellObjects + stringPayloads + vectorCapacity;
+        }
+    };
+
+    /**
+     * Memory allocated by CsvHandler, in bytes, see
+     * CsvHandler::getMemoryUsage. Category totals include all columns.
+     */
+    struct CsvMemoryUsage {
+        /**
+         * Usage of every column of current chunk. Columns not converted
+         * yet in lazy parsing mode are kept in fieldTapes only.
+         */
+        std::vector<CsvColumnMemoryUsage> columns;
+
+        /**
+         * Element objects of all columns and arena blocks kept for
+         * the next chunk.
+         */
+        long long cellObjects;
+        long long stringPayloads;
+        long long vectorCapacity;
+
+        /**
+         * Tokenized entries of current chunk and row bookkeeping.
+         */
+        long long fieldTapes;
+
+        /**
+         * Header, column types and per-column state.
+         */
+        long long metadata;
+
+        /**
+         * Chunk read buffers, stitched leftovers and probed bytes.
+         * Pages of the mapped file in load_mmap mode are not included.
+         */
+        long long readBuffers;
+
+        CsvMemoryUsage()
+        : cellObjects(0), stringPayloads(0), vectorCapacity(0), fieldTapes(0),
+        metadata(0), readBuffers(0) {
+        }
+
+        long long getTotal() const {
+            return cellObjects + stringPayloads + vectorCapacity + fieldTapes
+                    + metadata + readBuffers;
+        }
+    };
+}
+
+#endif /* CSVMEMORYUSAGE_HPP */
@@ -0,0 +1,63 @@
+/*
+ * File:   CsvRejectSink.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvRejectSink.hpp"
+#include "CsvHandlerExceptions.hpp"
+#include <sstream>
+
+using namespace csvh;
+
+std::string CsvRejectedEntry::getReason() const {
+    std::stringstream reason;
+    reason << "expected " << expectedFields << " fields, found " << amountOfFields;
+    return reason.str();
+}
+
+CsvRejectLog::CsvRejectLog(std::ostream& stream, long long maxLines)
+: _stream(&stream), _maxLines(maxLines), _loggedLines(0), _suppressedLines(0) {
+}
+
+void CsvRejectLog::reject(const CsvRejectedEntry& entry) {
+    if (_loggedLines >= _maxLines) {
+        ++_suppressedLines;
+        return;
+    }
+    ++_loggedLines;
+    *_stream << "Rejected line " << entry.lineNumber;
+    if (entry.byteOffset != -1) *_stream << " at byte " << entry.byteOffset;
+    *_stream << " (" << entry.getReason() << "): " << entry.line << std::endl;
+}
+
+void CsvRejectLog::flush() {
+    _stream->flush();
+}
+
+void CsvRejectLog::finish() {
+    if (_suppressedLines > 0) {
+        *_stream << _suppressedLines << " more rejected lines not logged" << std::endl;
+    }
+    _loggedLines = 0;
+    _suppressedLines = 0;
+}
+
+CsvRejectFile::CsvRejectFile(const std::string& fileName)
+: _fileStream(fileName, std::ios::binary) {
+    if (!_fileStream) {
+        throw UnableToOpenFileException();
+    }
+}
+
+void CsvRejectFile::reject(const CsvRejectedEntry& entry) {
+    _fileStream << entry.lineNumber << '\t' << entry.byteOffset << '\t'
+            << entry.getReason() << '\t' << entry.line << '\n';
+}
+
+void CsvRejectFile::flush() {
+    _fileStream.flush();
+}
+
+void CsvRejectCounter::reject(const CsvRejectedEntry& entry) {
+    if (_amountOfRejected++ == 0) _firstLineNumber = entry.lineNumber;
+}
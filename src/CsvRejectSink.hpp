@@ -0,0 +1,159 @@
+/*
+ * File:   CsvRejectSink.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVREJECTSINK_HPP
+#define CSVREJECTSINK_HPP
+
+#include <string>
+#include <ostream>
+#include <fstream>
+#include "CsvStringSlice.hpp"
+
+namespace csvh {
+
+    /**
+     * Entry line rejected by ignore_errors mode because of wrong number
+     * of fields.
+     */
+    struct CsvRejectedEntry {
+        /**
+         * Number of the entry line in the source, counted from 1 with
+         * header line included. Empty lines are not counted.
+         */
+        long long lineNumber;
+
+        /**
+         * Offset of the entry line in the source, -1 if not known,
+         * e.g. for JSON entries.
+         */
+        long long byteOffset;
+        long long amountOfFields;
+        long long expectedFields;
+
+        /**
+         * Text of the entry line, valid only during CsvRejectSink::reject.
+         */
+        CsvStringSlice line;
+
+        /**
+         * Method returns description of the reason of rejection.
+         *
+         * @return reason
+         */
+        std::string getReason() const;
+    };
+
+    /**
+     * Destination of rejected entry lines, set by
+     * CsvHandler::setRejectSink. Entries are passed in source order from
+     * a single thread.
+     */
+    class CsvRejectSink {
+    public:
+
+        virtual ~CsvRejectSink() {
+        }
+
+        /**
+         * Method is called for every rejected entry line.
+         *
+         * @param entry
+         */
+        virtual void reject(const CsvRejectedEntry& entry) = 0;
+
+        /**
+         * Method is called after every loaded chunk.
+         */
+        virtual void flush() {
+        }
+
+        /**
+         * Method is called once the last chunk of the source is loaded
+         * and after forEachRow.
+         */
+        virtual void finish() {
+            flush();
+        }
+    };
+
+    /**
+     * Sink writing rejected lines to a stream, std::cerr by default.
+     * Only the first maxLines lines of a load are written, lines rejected
+     * later are counted and reported with a single message when the load
+     * is finished. Stream is not owned and has to outlive the sink.
+     */
+    class CsvRejectLog : public CsvRejectSink {
+    public:
+
+        CsvRejectLog(std::ostream& stream, long long maxLines = 100);
+
+        virtual void reject(const CsvRejectedEntry& entry) override;
+        virtual void flush() override;
+        virtual void finish() override;
+
+    private:
+        std::ostream* _stream;
+        long long _maxLines;
+        long long _loggedLines;
+        long long _suppressedLines;
+    };
+
+    /**
+     * Sink writing rejected lines to a file, one tab separated record
+     * per line: line number, byte offset, reason and the line itself.
+     */
+    class CsvRejectFile : public CsvRejectSink {
+    public:
+
+        /**
+         * Throws UnableToOpenFileException if file can not be created.
+         *
+         * @param fileName
+         */
+        CsvRejectFile(const std::string& fileName);
+
+        virtual void reject(const CsvRejectedEntry& entry) override;
+        virtual void flush() override;
+
+    private:
+        std::ofstream _fileStream;
+    };
+
+    /**
+     * Sink counting rejected lines only.
+     */
+    class CsvRejectCounter : public CsvRejectSink {
+    public:
+
+        CsvRejectCounter() : _amountOfRejected(0), _firstLineNumber(-1) {
+        }
+
+        virtual void reject(const CsvRejectedEntry& entry) override;
+
+        long long getAmountOfRejected() const {
+            return _amountOfRejected;
+        }
+
+        /**
+         * Method returns line number of the first rejected line.
+         *
+         * @return line number, -1 if no line was rejected
+         */
+        long long getFirstLineNumber() const {
+            return _firstLineNumber;
+        }
+
+        void reset() {
+            _amountOfRejected = 0;
+            _firstLineNumber = -1;
+        }
+
+    private:
+        long long _amountOfRejected;
+        long long _firstLineNumber;
+    };
+}
+
+#endif /* CSVREJECTSINK_HPP */
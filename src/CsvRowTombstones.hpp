@@ -0,0 +1,136 @@
+/*
+ * File:   CsvRowTombstones.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVROWTOMBSTONES_HPP
+#define CSVROWTOMBSTONES_HPP
+
+#include <vector>
+#include <cstdint>
+
+namespace csvh {
+
+    /**
+     * Bitmap of removed rows of a loaded chunk. Removed rows are skipped
+     * by readers until the chunk is compacted. Index of the n-th row left
+     * is found in O(log n) with a Fenwick tree of rows left per bitmap
+     * word, so removing rows one by one does not shift columns.
+     */
+    class CsvRowTombstones {
+    public:
+
+        CsvRowTombstones() : _rows(0), _removed(0) {
+        }
+
+        /**
+         * Method is used to track given amount of rows, none is removed.
+         *
+         * @param amountOfRows
+         */
+        void reset(long long amountOfRows) {
+            _rows = amountOfRows;
+            _removed = 0;
+            _words.assign((amountOfRows + 63) / 64, 0);
+            _rowsLeft.assign(_words.size() + 1, 0);
+            for (unsigned long word = 1; word < _rowsLeft.size(); ++word) {
+                _rowsLeft[word] += rowsInWord(word - 1);
+                unsigned long parent = word + (word & (0 - word));
+                if (parent < _rowsLeft.size()) _rowsLeft[parent] += _rowsLeft[word];
+            }
+        }
+
+        /**
+         * Method is used to free the bitmap.
+         */
+        void clear() {
+            _rows = 0;
+            _removed = 0;
+            std::vector<uint64_t>().swap(_words);
+            std::vector<long long>().swap(_rowsLeft);
+        }
+
+        /**
+         * Method is used to mark row as removed.
+         *
+         * @param row
+         * @return false when row was already removed
+         */
+        bool remove(long long row) {
+            uint64_t bit = 1ULL << (row % 64);
+            if (_words[row / 64] & bit) return false;
+            _words[row / 64] |= bit;
+            ++_removed;
+            for (unsigned long word = row / 64 + 1; word < _rowsLeft.size();
+                    word += word & (0 - word)) {
+                --_rowsLeft[word];
+            }
+            return true;
+        }
+
+        bool isRemoved(long long row) const {
+            return _removed != 0 && ((_words[row / 64] >> (row % 64)) & 1);
+        }
+
+        /**
+         * Method returns index of the n-th row which is not removed.
+         *
+         * @param rowLeft - index counting only rows left
+         * @return row index
+         */
+        long long findRow(long long rowLeft) const {
+            if (_removed == 0) return rowLeft;
+            unsigned long word = 0;
+            unsigned long step = 1;
+            while (step * 2 < _rowsLeft.size()) step *= 2;
+            for (; step > 0; step /= 2) {
+                if (word + step < _rowsLeft.size()
+                        && _rowsLeft[word + step] <= rowLeft) {
+                    word += step;
+                    rowLeft -= _rowsLeft[word];
+                }
+            }
+            uint64_t bitsLeft = ~_words[word];
+            for (; rowLeft > 0; --rowLeft) bitsLeft &= bitsLeft - 1;
+            return word * 64 + __builtin_ctzll(bitsLeft);
+        }
+
+        /**
+         * Amount of tracked rows, removed ones included.
+         */
+        long long size() const {
+            return _rows;
+        }
+
+        long long countRemoved() const {
+            return _removed;
+        }
+
+        long long countLeft() const {
+            return _rows - _removed;
+        }
+
+        /**
+         * Method returns bytes allocated by the bitmap.
+         *
+         * @return memory usage
+         */
+        long long getMemoryUsage() const {
+            return _words.capacity() * sizeof (uint64_t)
+                    + _rowsLeft.capacity() * sizeof (long long);
+        }
+
+    private:
+        long long _rows;
+        long long _removed;
+        std::vector<uint64_t> _words;
+        std::vector<long long> _rowsLeft;
+
+        long long rowsInWord(unsigned long word) const {
+            long long rows = _rows - (long long) word * 64;
+            return rows < 64 ? rows : 64;
+        }
+    };
+}
+
+#endif /* CSVROWTOMBSTONES_HPP */
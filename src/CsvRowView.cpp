@@ -0,0 +1,114 @@
+/*
+ * File:   CsvRowView.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvRowView.hpp"
+#include "CsvHandlerExceptions.hpp"
+#include "CsvFieldParser.hpp"
+#include <stdexcept>
+#include <limits>
+#include <cstdio>
+
+using namespace csvh;
+
+CsvStringSlice CsvRowView::getString(int columnIndex) const {
+    if (columnIndex < 0 || columnIndex >= (int) _fields->size()) {
+        throw std::out_of_range("Column index is out of range!");
+    }
+    if (_values == nullptr) return (*_fields)[columnIndex];
+    CsvRowValue& value = (*_values)[columnIndex];
+    if (value.kind == CsvRowValue::value_text) return (*_fields)[columnIndex];
+    if (value.buffer.empty()) {
+        if (value.kind == CsvRowValue::value_date) {
+            value.buffer = _dateFormat->format(value.integer);
+        } else {
+            // Numbers are written the same as by getRow.
+            char text[32];
+            int length = value.kind == CsvRowValue::value_integer
+                    ? std::snprintf(text, sizeof (text), "%lld", value.integer)
+                    : std::snprintf(text, sizeof (text), "%g", value.real);
+            value.buffer.assign(text, length);
+        }
+    }
+    return CsvStringSlice(value.buffer);
+}
+
+int CsvRowView::getInt(int columnIndex) const {
+    const CsvRowValue* stored = getValue(columnIndex, CsvRowValue::value_integer);
+    if (stored != nullptr && stored->integer >= std::numeric_limits<int>::min()
+            && stored->integer <= std::numeric_limits<int>::max()) {
+        return (int) stored->integer;
+    }
+    CsvStringSlice field = getString(columnIndex);
+    int value;
+    _parseStatus status = CsvFieldParser::parseInt(field.begin(), field.end(), value);
+    if (status != parse_ok) {
+        throwConversionError(UnableToConvertFieldTypeException::_convertIntErrorMsg,
+                CsvFieldParser::getStatusMessage(status), columnIndex);
+    }
+    return value;
+}
+
+long long CsvRowView::getInt64(int columnIndex) const {
+    const CsvRowValue* stored = getValue(columnIndex, CsvRowValue::value_integer);
+    if (stored != nullptr) return stored->integer;
+    CsvStringSlice field = getString(columnIndex);
+    long long value;
+    _parseStatus status = CsvFieldParser::parseInt64(field.begin(), field.end(), value);
+    if (status != parse_ok) {
+        throwConversionError(UnableToConvertFieldTypeException::_convertIntErrorMsg,
+                CsvFieldParser::getStatusMessage(status), columnIndex);
+    }
+    return value;
+}
+
+double CsvRowView::getDouble(int columnIndex) const {
+    const CsvRowValue* stored = getValue(columnIndex, CsvRowValue::value_double);
+    if (stored != nullptr) return stored->real;
+    CsvStringSlice field = getString(columnIndex);
+    double value;
+    _parseStatus status = CsvFieldParser::parseDouble(field.begin(), field.end(), value);
+    if (status != parse_ok) {
+        throwConversionError(UnableToConvertFieldTypeException::_convertDoubleErrorMsg,
+                CsvFieldParser::getStatusMessage(status), columnIndex);
+    }
+    return value;
+}
+
+std::time_t CsvRowView::getDate(int columnIndex) const {
+    const CsvRowValue* stored = getValue(columnIndex, CsvRowValue::value_date);
+    if (stored != nullptr) return stored->integer;
+    CsvStringSlice field = getString(columnIndex);
+    std::time_t value;
+    if (_dateFormat->parse(field.begin(), field.end(), value) != parse_ok) {
+        throw UnableToConvertFieldTypeException(
+                UnableToConvertFieldTypeException::_convertDateErrorMsg);
+    }
+    return value;
+}
+
+const CsvRowValue* CsvRowView::getValue(int columnIndex,
+        CsvRowValue::_valueKind kind) const {
+    if (_values == nullptr || columnIndex < 0
+            || columnIndex >= (int) _values->size()) {
+        return nullptr;
+    }
+    const CsvRowValue& value = (*_values)[columnIndex];
+    if (value.kind != CsvRowValue::value_text && !value.set) {
+        std::stringstream msg;
+        msg << "Row " << _rowIndex << ": field of column " << columnIndex
+                << " is not set" << UnableToConvertFieldTypeException::_typeNotCorrectMsg;
+        throw UnableToConvertFieldTypeException(msg.str());
+    }
+    // Other kinds are converted from text, e.g. double read as int.
+    return value.kind == kind ? &value : nullptr;
+}
+
+void CsvRowView::throwConversionError(const char* errorMsg,
+        const char* reasonMsg, int columnIndex) const {
+    std::stringstream msg;
+    msg << "Row " << _rowIndex << ": " << errorMsg
+            << getString(columnIndex) << reasonMsg;
+    throw UnableToConvertFieldTypeException(msg.str());
+}
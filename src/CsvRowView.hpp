@@ -0,0 +1,145 @@
+/*
+ * File:   CsvRowView.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVROWVIEW_HPP
+#define CSVROWVIEW_HPP
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include "CsvStringSlice.hpp"
+#include "CsvDateFormat.hpp"
+
+namespace csvh {
+
+    /**
+     * Converted value of a field passed to CsvRowView instead of its text,
+     * e.g. of a column already stored by CsvHandler. Text of the value
+     * is written to buffer only when the field is read as string.
+     */
+    struct CsvRowValue {
+
+        enum _valueKind {
+            value_text,
+            value_integer,
+            value_double,
+            value_date
+        };
+
+        CsvRowValue() : kind(value_text), set(true), integer(0), real(0) {
+        }
+
+        _valueKind kind;
+        bool set;
+        long long integer;
+        double real;
+        std::string buffer;
+    };
+
+    /**
+     * Lightweight view of a single entry passed to CsvHandler::forEachRow.
+     * Fields reference bytes of the read buffer, so view and returned
+     * slices are valid only inside the callback.
+     * Typed accessors convert field text on demand, without heap allocation.
+     */
+    class CsvRowView {
+    public:
+
+        CsvRowView(const std::vector<CsvStringSlice>& fields, long long rowIndex,
+                const CsvDateFormat* dateFormat = nullptr)
+        : _fields(&fields), _rowIndex(rowIndex),
+        _dateFormat(dateFormat != nullptr ? dateFormat
+        : &CsvDateFormat::getDefaultFormat()), _values(nullptr) {
+        }
+
+        /**
+         * Constructor of view whose fields of kind other than value_text
+         * are read from values, without parsing their text.
+         * Unset values can be read only as string.
+         */
+        CsvRowView(const std::vector<CsvStringSlice>& fields,
+                std::vector<CsvRowValue>& values, long long rowIndex,
+                const CsvDateFormat* dateFormat = nullptr)
+        : _fields(&fields), _rowIndex(rowIndex),
+        _dateFormat(dateFormat != nullptr ? dateFormat
+        : &CsvDateFormat::getDefaultFormat()), _values(&values) {
+        }
+
+        /**
+         * Method returns index of the entry in the whole file.
+         * Header line is not counted.
+         *
+         * @return row index
+         */
+        long long getRowIndex() const {
+            return _rowIndex;
+        }
+
+        /**
+         * Method returns number of fields in the entry.
+         *
+         * @return number of fields
+         */
+        int getAmountOfColumns() const {
+            return _fields->size();
+        }
+
+        /**
+         * Method returns raw text of the field. Quotation marks are kept,
+         * the same as for type_string columns.
+         * Throws std::out_of_range for invalid column index.
+         *
+         * @param columnIndex
+         * @return field text
+         */
+        CsvStringSlice getString(int columnIndex) const;
+
+        /**
+         * Methods convert field to selected type.
+         * Throw UnableToConvertFieldTypeException when conversion
+         * is not possible and std::out_of_range for invalid column index.
+         *
+         * @param columnIndex
+         * @return field value
+         */
+        int getInt(int columnIndex) const;
+        long long getInt64(int columnIndex) const;
+        double getDouble(int columnIndex) const;
+        std::time_t getDate(int columnIndex) const;
+
+        CsvStringSlice operator[](int columnIndex) const {
+            return getString(columnIndex);
+        }
+
+    private:
+        const std::vector<CsvStringSlice>* _fields;
+        long long _rowIndex;
+        const CsvDateFormat* _dateFormat;
+        std::vector<CsvRowValue>* _values;
+
+        /**
+         * Method returns converted value of the field, nullptr when
+         * the field has to be parsed from its text.
+         *
+         * @param columnIndex
+         * @param kind - kind of value read
+         * @return value
+         */
+        const CsvRowValue* getValue(int columnIndex,
+                CsvRowValue::_valueKind kind) const;
+
+        /**
+         * Method is used to throw conversion exception for the field.
+         *
+         * @param errorMsg - destination type message
+         * @param reasonMsg
+         * @param columnIndex
+         */
+        void throwConversionError(const char* errorMsg, const char* reasonMsg,
+                int columnIndex) const;
+    };
+}
+
+#endif /* CSVROWVIEW_HPP */
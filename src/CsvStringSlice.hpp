@@ -0,0 +1,106 @@
+/*
+ * File:   CsvStringSlice.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVSTRINGSLICE_HPP
+#define CSVSTRINGSLICE_HPP
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace csvh {
+
+    /**
+     * Non-owning reference to a range of characters inside a read buffer
+     * or a mapped file. Slice is valid as long as referenced bytes are alive.
+     */
+    class CsvStringSlice {
+    public:
+
+        CsvStringSlice() : _data(nullptr), _length(0) {
+        }
+
+        CsvStringSlice(const char* data, size_t length)
+        : _data(data), _length(length) {
+        }
+
+        CsvStringSlice(const std::string& str)
+        : _data(str.data()), _length(str.size()) {
+        }
+
+        const char* data() const {
+            return _data;
+        }
+
+        const char* begin() const {
+            return _data;
+        }
+
+        const char* end() const {
+            return _data + _length;
+        }
+
+        size_t size() const {
+            return _length;
+        }
+
+        bool empty() const {
+            return _length == 0;
+        }
+
+        char operator[](size_t pos) const {
+            return _data[pos];
+        }
+
+        std::string toString() const {
+            return std::string(_data, _length);
+        }
+
+        /**
+         * Method is used to compare slice with string, the same way
+         * as std::string::compare.
+         *
+         * @param str
+         * @return negative, 0 or positive value
+         */
+        int compare(const std::string& str) const {
+            size_t length = std::min(_length, str.size());
+            int result = length > 0 ? std::memcmp(_data, str.data(), length) : 0;
+            if (result != 0) return result;
+            return _length < str.size() ? -1 : (_length > str.size() ? 1 : 0);
+        }
+
+    private:
+        const char* _data;
+        size_t _length;
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const CsvStringSlice& slice) {
+        return os.write(slice.data(), slice.size());
+    }
+
+    inline bool operator==(const CsvStringSlice& first, const CsvStringSlice& second) {
+        return first.size() == second.size() && (first.empty()
+                || std::memcmp(first.data(), second.data(), first.size()) == 0);
+    }
+
+    /**
+     * FNV-1a hash of slice bytes, e.g. for std::unordered_map keys.
+     */
+    struct CsvStringSliceHash {
+
+        size_t operator()(const CsvStringSlice& slice) const {
+            size_t hash = 14695981039346656037ULL;
+            for (char c : slice) {
+                hash = (hash ^ (unsigned char) c) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+}
+
+#endif /* CSVSTRINGSLICE_HPP */
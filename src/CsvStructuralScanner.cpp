@@ -0,0 +1,351 @@
+/*
+ * File:   CsvStructuralScanner.cpp
+ * Author: dawidtoczek
+ */
+
+#include "CsvStructuralScanner.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CSVH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace csvh;
+
+namespace {
+
+    const char _quotationMark = '"';
+    const char _space = ' ';
+    const char _tab = '\t';
+    const char _CR = '\r';
+    const char _LF = '\n';
+
+    void scanBlockScalar(const char* data, char delimiter, CsvBlockMasks& masks) {
+        masks.delimiters = masks.quotes = masks.lineEndings = 0;
+        for (int pos = 0; pos < CsvStructuralScanner::_blockSize; ++pos) {
+            uint64_t bit = 1ULL << pos;
+            char c = data[pos];
+            if (c == delimiter) masks.delimiters |= bit;
+            if (c == _quotationMark) masks.quotes |= bit;
+            if (c == _CR || c == _LF) masks.lineEndings |= bit;
+        }
+    }
+
+    uint64_t prefixXorScalar(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+#ifdef CSVH_X86_KERNELS
+
+    __attribute__((target("sse2")))
+    inline uint64_t matchSse2(__m128i b0, __m128i b1, __m128i b2, __m128i b3,
+            char c) {
+        __m128i pattern = _mm_set1_epi8(c);
+        uint64_t r0 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(b0, pattern));
+        uint64_t r1 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(b1, pattern));
+        uint64_t r2 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(b2, pattern));
+        uint64_t r3 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(b3, pattern));
+        return r0 | (r1 << 16) | (r2 << 32) | (r3 << 48);
+    }
+
+    __attribute__((target("sse2")))
+    void scanBlockSse2(const char* data, char delimiter, CsvBlockMasks& masks) {
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*> (data));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*> (data + 16));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*> (data + 32));
+        __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*> (data + 48));
+        masks.delimiters = matchSse2(b0, b1, b2, b3, delimiter);
+        masks.quotes = matchSse2(b0, b1, b2, b3, _quotationMark);
+        masks.lineEndings = matchSse2(b0, b1, b2, b3, _CR)
+                | matchSse2(b0, b1, b2, b3, _LF);
+    }
+
+    __attribute__((target("avx2")))
+    inline uint64_t matchAvx2(__m256i lo, __m256i hi, char c) {
+        __m256i pattern = _mm256_set1_epi8(c);
+        uint64_t rLo = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, pattern));
+        uint64_t rHi = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, pattern));
+        return rLo | (rHi << 32);
+    }
+
+    __attribute__((target("avx2")))
+    void scanBlockAvx2(const char* data, char delimiter, CsvBlockMasks& masks) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (data));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*> (data + 32));
+        masks.delimiters = matchAvx2(lo, hi, delimiter);
+        masks.quotes = matchAvx2(lo, hi, _quotationMark);
+        masks.lineEndings = matchAvx2(lo, hi, _CR) | matchAvx2(lo, hi, _LF);
+    }
+
+    /**
+     * Carry-less multiplication by all ones computes prefix xor, so bit n
+     * of result tells if odd number of quotes is at positions 0..n.
+     */
+    __attribute__((target("pclmul,sse2")))
+    uint64_t prefixXorClmul(uint64_t bits) {
+        __m128i product = _mm_clmulepi64_si128(
+                _mm_set_epi64x(0, bits), _mm_set1_epi8(-1), 0);
+        return _mm_cvtsi128_si64(product);
+    }
+
+    inline int countTrailingZeros(uint64_t bits) {
+        return __builtin_ctzll(bits);
+    }
+#else
+
+    inline int countTrailingZeros(uint64_t bits) {
+        int count = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            ++count;
+        }
+        return count;
+    }
+#endif
+}
+
+_scannerImplementation CsvStructuralScanner::_implementation =
+        CsvStructuralScanner::detectImplementation();
+
+_scannerImplementation CsvStructuralScanner::detectImplementation() {
+#ifdef CSVH_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return scanner_avx2;
+    if (__builtin_cpu_supports("sse2")) return scanner_sse2;
+#endif
+    return scanner_scalar;
+}
+
+bool CsvStructuralScanner::useImplementation(
+        _scannerImplementation implementation) {
+    if (implementation > detectImplementation()) return false;
+    _implementation = implementation;
+    return true;
+}
+
+_scannerImplementation CsvStructuralScanner::getImplementation() {
+    return _implementation;
+}
+
+CsvStructuralScanner::CsvStructuralScanner(char delimiter)
+: _delimiter(delimiter), _scanFullBlock(scanBlockScalar),
+_prefixXor(prefixXorScalar) {
+#ifdef CSVH_X86_KERNELS
+    if (_implementation == scanner_avx2) {
+        _scanFullBlock = scanBlockAvx2;
+    } else if (_implementation == scanner_sse2) {
+        _scanFullBlock = scanBlockSse2;
+    }
+    if (_implementation != scanner_scalar && __builtin_cpu_supports("pclmul")) {
+        _prefixXor = prefixXorClmul;
+    }
+#endif
+}
+
+void CsvStructuralScanner::scanBlock(const char* data, long long size,
+        CsvBlockMasks& masks) const {
+    if (size >= _blockSize) {
+        _scanFullBlock(data, _delimiter, masks);
+    } else {
+        // Bytes behind the end are not readable, block is padded instead.
+        char paddedBlock[_blockSize];
+        memcpy(paddedBlock, data, size);
+        memset(paddedBlock + size, _delimiter == 0 ? _space : 0, _blockSize - size);
+        _scanFullBlock(paddedBlock, _delimiter, masks);
+    }
+}
+
+CsvLineCursor CsvStructuralScanner::findLineEndings(const char* begin,
+        const char* end) const {
+    CsvLineCursor cursor = {begin - _blockSize, end, 0};
+    return cursor;
+}
+
+const char* CsvStructuralScanner::nextLineEnding(CsvLineCursor& cursor) const {
+    while (!cursor.lineEndings) {
+        cursor.block += _blockSize;
+        if (cursor.block >= cursor.end) {
+            cursor.block = cursor.end;
+            return cursor.end;
+        }
+        CsvBlockMasks masks;
+        scanBlock(cursor.block, cursor.end - cursor.block, masks);
+        cursor.lineEndings = masks.lineEndings;
+    }
+    const char* lineEnding = cursor.block + countTrailingZeros(cursor.lineEndings);
+    cursor.lineEndings &= cursor.lineEndings - 1;
+    return lineEnding;
+}
+
+void CsvStructuralScanner::advanceCursor(FieldCursor& cursor,
+        long long position) const {
+    while (position >= cursor.blockStart + _blockSize) {
+        cursor.blockStart += _blockSize;
+        CsvBlockMasks masks;
+        scanBlock(cursor.data + cursor.blockStart,
+                cursor.length - cursor.blockStart, masks);
+        uint64_t quotedThrough = _prefixXor(masks.quotes) ^ (0 - cursor.quoteCarry);
+        cursor.delimiters = masks.delimiters;
+        cursor.quotedBefore = (quotedThrough << 1) | cursor.quoteCarry;
+        cursor.quoteCarry = quotedThrough >> 63;
+    }
+}
+
+long long CsvStructuralScanner::nextDelimiter(FieldCursor& cursor,
+        long long from, bool quotedField) const {
+    advanceCursor(cursor, from);
+    int offset = from - cursor.blockStart;
+    uint64_t quoteParity = 0 - ((cursor.quotedBefore >> offset) & 1);
+    uint64_t candidates = cursor.delimiters & (~0ULL << offset);
+
+    while (true) {
+        if (quotedField) {
+            candidates &= ~(cursor.quotedBefore ^ quoteParity);
+        }
+        if (candidates) {
+            return cursor.blockStart + countTrailingZeros(candidates);
+        }
+        if (cursor.blockStart + _blockSize >= cursor.length) {
+            return -1;
+        }
+        advanceCursor(cursor, cursor.blockStart + _blockSize);
+        candidates = cursor.delimiters;
+    }
+}
+
+template<class FieldSink>
+void CsvStructuralScanner::splitLine(const CsvStringSlice& line,
+        const FieldSink& sink) const {
+    const char* data = line.data();
+    long long length = line.size();
+    FieldCursor cursor = {data, length, -_blockSize, 0, 0, 0};
+    long long poss = 0;
+    long long pose = 0;
+
+    while (poss <= length && pose != -1) {
+        while (poss < length && (data[poss] == _space || data[poss] == _tab)) {
+            ++poss;
+        }
+        if (poss == length) {
+            sink(data + length, 0, false);
+            break;
+        }
+
+        bool quotedField = data[poss] == _quotationMark;
+        if (quotedField) {
+            pose = nextDelimiter(cursor, poss, true);
+            if (pose == -1) pose = length;
+        } else {
+            pose = nextDelimiter(cursor, poss, false);
+        }
+
+        long long fieldEnd = pose == -1 ? length : pose;
+        while (fieldEnd - poss > 1 && (data[fieldEnd - 1] == _space
+                || data[fieldEnd - 1] == _tab)) {
+            --fieldEnd;
+        }
+        sink(data + poss, fieldEnd - poss, quotedField);
+        poss = pose + 1;
+    }
+}
+
+void CsvStructuralScanner::splitFields(const CsvStringSlice& line,
+        std::vector<CsvStringSlice>& fields) const {
+    splitLine(line, [&fields](const char* field, long long length, bool) {
+        fields.emplace_back(field, length);
+    });
+}
+
+const char* CsvStructuralScanner::tokenize(const char* begin, const char* end,
+        CsvFieldTape& tape, bool endOfData) const {
+    const char* lineBegin = begin;
+    const char* fieldBegin = begin;
+    bool rowStarted = false;
+    bool fieldStarted = false;
+    bool quotedField = false;
+    // Quote parity is counted from the beginning of the buffer, parity
+    // before line and field beginning is kept to compare with delimiters.
+    uint64_t lineParity = 0;
+    uint64_t fieldParity = 0;
+    uint64_t quoteCarry = 0;
+
+    auto addField = [&tape, &fieldBegin, &quotedField](const char* fieldEnd) {
+        while (fieldEnd - fieldBegin > 1 && (fieldEnd[-1] == _space
+                || fieldEnd[-1] == _tab)) {
+            --fieldEnd;
+        }
+        tape.addField(fieldBegin, fieldEnd - fieldBegin, quotedField);
+    };
+    // Leading spaces and tabs are skipped, field reaching line ending
+    // is the last, empty one.
+    auto startField = [&](const char* from, uint64_t parity) {
+        while (from < end && (*from == _space || *from == _tab)) ++from;
+        if (from == end || *from == _CR || *from == _LF) {
+            tape.addField(from, 0, false);
+            fieldStarted = false;
+            return;
+        }
+        fieldBegin = from;
+        fieldParity = parity;
+        quotedField = *from == _quotationMark;
+        fieldStarted = true;
+    };
+    auto startRow = [&]() {
+        tape.beginRow(lineBegin);
+        rowStarted = true;
+        startField(lineBegin, lineParity);
+    };
+
+    for (const char* block = begin; block < end; block += _blockSize) {
+        CsvBlockMasks masks;
+        scanBlock(block, end - block, masks);
+        uint64_t quotedThrough = _prefixXor(masks.quotes) ^ (0 - quoteCarry);
+        uint64_t quotedBefore = (quotedThrough << 1) | quoteCarry;
+        quoteCarry = quotedThrough >> 63;
+
+        uint64_t structurals = masks.delimiters | masks.lineEndings;
+        while (structurals) {
+            int offset = countTrailingZeros(structurals);
+            structurals &= structurals - 1;
+            const char* position = block + offset;
+            uint64_t parity = (quotedBefore >> offset) & 1;
+
+            if ((masks.lineEndings >> offset) & 1) {
+                // Empty lines are skipped.
+                if (position > lineBegin) {
+                    if (!rowStarted) startRow();
+                    if (fieldStarted) addField(position);
+                    tape.endRow(position);
+                }
+                rowStarted = fieldStarted = false;
+                lineBegin = position + 1;
+                lineParity = parity;
+                continue;
+            }
+
+            if (!rowStarted) startRow();
+            // Delimiter of quoted field has to be preceded by even number
+            // of quotation marks counted from the field beginning.
+            if (!fieldStarted || (quotedField && parity != fieldParity)) continue;
+            addField(position);
+            startField(position + 1, parity);
+        }
+    }
+
+    if (lineBegin < end && endOfData) {
+        if (!rowStarted) startRow();
+        if (fieldStarted) addField(end);
+        tape.endRow(end);
+        lineBegin = end;
+    } else if (rowStarted) {
+        tape.removeLastRow();
+    }
+    return lineBegin;
+}
@@ -0,0 +1,183 @@
+/*
+ * File:   CsvStructuralScanner.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVSTRUCTURALSCANNER_HPP
+#define CSVSTRUCTURALSCANNER_HPP
+
+#include <vector>
+#include <cstdint>
+#include "CsvStringSlice.hpp"
+#include "CsvFieldTape.hpp"
+
+namespace csvh {
+
+    /**
+     * Enum to represent implementation of structural character scanning.
+     */
+    enum _scannerImplementation {
+        scanner_scalar,
+        scanner_sse2,
+        scanner_avx2
+    };
+
+    /**
+     * Bit masks of structural characters in a block of 64 bytes.
+     * Bit n is set when byte n of the block matches.
+     */
+    struct CsvBlockMasks {
+        uint64_t delimiters;
+        uint64_t quotes;
+        uint64_t lineEndings;
+    };
+
+    /**
+     * Position of line endings search. Every block is scanned once and
+     * following line endings are taken from its mask.
+     */
+    struct CsvLineCursor {
+        const char* block;
+        const char* end;
+        uint64_t lineEndings;
+    };
+
+    /**
+     * Class is used to find delimiters, quotation marks and line endings
+     * 64 bytes at a time. AVX2 or SSE2 kernel is chosen at runtime,
+     * scalar one is used on other CPUs. Quoted regions are resolved with
+     * carry-less multiplication (prefix xor of quote mask), so fields are
+     * split without scanning them character by character.
+     */
+    class CsvStructuralScanner {
+    public:
+
+        static const int _blockSize = 64;
+
+        CsvStructuralScanner(char delimiter = ',');
+
+        /**
+         * Method is used to start search of CR and LF characters.
+         *
+         * @param begin
+         * @param end
+         * @return cursor for nextLineEnding
+         */
+        CsvLineCursor findLineEndings(const char* begin, const char* end) const;
+
+        /**
+         * Method is used to get next CR or LF character.
+         *
+         * @param cursor
+         * @return position of line ending, end of data if not found
+         */
+        const char* nextLineEnding(CsvLineCursor& cursor) const;
+
+        /**
+         * Method is used to split line into fields.
+         * Leading and trailing spaces and tabs are skipped. Field starting
+         * with quotation mark ends at the first delimiter preceded by an even
+         * number of quotation marks counted from the field beginning.
+         *
+         * @param line
+         * @param fields - slices referencing bytes of line are appended
+         */
+        void splitFields(const CsvStringSlice& line,
+                std::vector<CsvStringSlice>& fields) const;
+
+        /**
+         * Method is used to split lines of the buffer into fields in a single
+         * pass over structural characters, line and field boundaries are
+         * taken from the same block masks. Fields are split the same way
+         * as by splitFields. Empty lines are skipped.
+         *
+         * @param begin
+         * @param end
+         * @param tape - entries are appended
+         * @param endOfData - unfinished last line is added as an entry too
+         * @return beginning of the unfinished last line, end if there is none
+         */
+        const char* tokenize(const char* begin, const char* end,
+                CsvFieldTape& tape, bool endOfData = false) const;
+
+        /**
+         * Method is used to compute masks for a single block.
+         *
+         * @param data
+         * @param size - at most _blockSize, bits behind size are not set
+         * @param masks
+         */
+        void scanBlock(const char* data, long long size, CsvBlockMasks& masks) const;
+
+        /**
+         * Method is used to force scanner implementation, e.g. for
+         * benchmarks. By default the fastest supported one is used.
+         *
+         * @param implementation
+         * @return false if implementation is not supported by the CPU
+         */
+        static bool useImplementation(_scannerImplementation implementation);
+
+        /**
+         * Method returns implementation used by scanners.
+         *
+         * @return implementation
+         */
+        static _scannerImplementation getImplementation();
+
+    private:
+        char _delimiter;
+
+        typedef void (*scan_function)(const char*, char, CsvBlockMasks&);
+        typedef uint64_t(*prefix_xor_function)(uint64_t);
+
+        scan_function _scanFullBlock;
+        prefix_xor_function _prefixXor;
+
+        /**
+         * Position in line with masks of the current block.
+         */
+        struct FieldCursor {
+            const char* data;
+            long long length;
+            long long blockStart;
+            uint64_t delimiters;
+            /**
+             * Bit n is set when odd number of quotation marks
+             * precedes byte n in the line.
+             */
+            uint64_t quotedBefore;
+            uint64_t quoteCarry;
+        };
+
+        /**
+         * Method is used to move cursor to the block containing position.
+         * Cursor never moves backwards.
+         */
+        void advanceCursor(FieldCursor& cursor, long long position) const;
+
+        /**
+         * Method is used to find next delimiter from given position.
+         *
+         * @param cursor
+         * @param from
+         * @param quotedField - delimiter has to be preceded by
+         *        the same number of quotation marks modulo 2 as from
+         * @return delimiter position, -1 if not found
+         */
+        long long nextDelimiter(FieldCursor& cursor, long long from,
+                bool quotedField) const;
+
+        /**
+         * Method is used to split line into fields passed to
+         * sink(field, length, quoted).
+         */
+        template<class FieldSink>
+        void splitLine(const CsvStringSlice& line, const FieldSink& sink) const;
+
+        static _scannerImplementation _implementation;
+        static _scannerImplementation detectImplementation();
+    };
+}
+
+#endif /* CSVSTRUCTURALSCANNER_HPP */
@@ -0,0 +1,263 @@
+/*
+ * File:   CsvTypedTable.hpp
+ * Author: dawidtoczek
+ */
+
+#ifndef CSVTYPEDTABLE_HPP
+#define CSVTYPEDTABLE_HPP
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <ctime>
+#include "CsvHandler.hpp"
+
+namespace csvh {
+
+    /**
+     * Conversion of a field to column type, selected at compile time.
+     * Only int, long long, double, CsvDate and std::string are supported.
+     * Dates are declared with the CsvDate tag and kept as std::time_t,
+     * which can be the same type as long long.
+     */
+    template <class T>
+    struct CsvColumnTraits;
+
+    template <>
+    struct CsvColumnTraits<int> {
+        typedef int value_type;
+        static constexpr _dataTypes type = type_int;
+
+        static int convert(const CsvRowView& row, int columnIndex) {
+            return row.getInt(columnIndex);
+        }
+    };
+
+    template <>
+    struct CsvColumnTraits<long long> {
+        typedef long long value_type;
+        static constexpr _dataTypes type = type_int64;
+
+        static long long convert(const CsvRowView& row, int columnIndex) {
+            return row.getInt64(columnIndex);
+        }
+    };
+
+    template <>
+    struct CsvColumnTraits<double> {
+        typedef double value_type;
+        static constexpr _dataTypes type = type_double;
+
+        static double convert(const CsvRowView& row, int columnIndex) {
+            return row.getDouble(columnIndex);
+        }
+    };
+
+    template <>
+    struct CsvColumnTraits<CsvDate> {
+        typedef std::time_t value_type;
+        static constexpr _dataTypes type = type_date;
+
+        static std::time_t convert(const CsvRowView& row, int columnIndex) {
+            return row.getDate(columnIndex);
+        }
+    };
+
+    template <>
+    struct CsvColumnTraits<std::string> {
+        typedef std::string value_type;
+        static constexpr _dataTypes type = type_string;
+
+        static std::string convert(const CsvRowView& row, int columnIndex) {
+            return row.getString(columnIndex).toString();
+        }
+    };
+
+    /**
+     * Table with schema known at compile time, e.g.
+     * TypedTable<int, double, std::string, CsvDate>.
+     * Entries are read with CsvHandler::forEachRow and every field is
+     * converted straight into a typed column vector, so no
+     * CsvEntryElement objects, type map lookups or casts are involved.
+     */
+    template <class... Columns>
+    class TypedTable {
+    public:
+
+        typedef std::tuple<typename CsvColumnTraits<Columns>::value_type...>
+        csv_typedRow;
+
+        /**
+         * Type of values of the column, std::time_t for CsvDate.
+         */
+        template <unsigned int I>
+        using column_type = typename std::tuple_element<I, csv_typedRow>::type;
+
+        template <unsigned int I>
+        using column_tag = typename std::tuple_element<I,
+                std::tuple<Columns...> >::type;
+
+        static constexpr unsigned int _amountOfColumns = sizeof...(Columns);
+
+        /**
+         * Method returns type of the column as used by CsvHandler.
+         *
+         * @return data type
+         */
+        template <unsigned int I>
+        static constexpr _dataTypes getColumnType() {
+            return CsvColumnTraits<column_tag<I> >::type;
+        }
+
+        /**
+         * Method is used to read all entries of the handler's source.
+         * Previously loaded entries are removed. Handler settings like
+         * delimiter, header mode or date format are used.
+         *
+         * @param handler - source of entries
+         * @param errorHandlingMode - by default entry with wrong number of
+         *        fields or not convertible field stops reading. With
+         *        ignore_errors such entry is skipped and not convertible
+         *        field gets default value.
+         * @return number of loaded entries
+         */
+        long long load(CsvHandler& handler,
+                _errorHandlingMode errorHandlingMode = stop_on_error) {
+            clear();
+            handler.forEachRow([this, errorHandlingMode](const CsvRowView & row) {
+                if (row.getAmountOfColumns() != (int) _amountOfColumns) {
+                    if (errorHandlingMode == ignore_errors) return true;
+                    throw UnableToSplitEntryException(row.getRowIndex());
+                }
+                // Whole entry is converted first, so that not convertible
+                // field leaves all columns of the same size.
+                csv_typedRow typedRow;
+                ColumnReader<0, _amountOfColumns>::read(typedRow, row,
+                        errorHandlingMode);
+                ColumnReader<0, _amountOfColumns>::append(_columns, typedRow);
+                ++_amountOfEntries;
+                return true;
+            }, errorHandlingMode);
+            return _amountOfEntries;
+        }
+
+        long long getAmountOfEntries() const {
+            return _amountOfEntries;
+        }
+
+        /**
+         * Method returns values of the column.
+         *
+         * @return column vector
+         */
+        template <unsigned int I>
+        const std::vector<column_type<I> >& getColumn() const {
+            return std::get<I>(_columns);
+        }
+
+        template <unsigned int I>
+        std::vector<column_type<I> >& getColumn() {
+            return std::get<I>(_columns);
+        }
+
+        /**
+         * Method returns single value.
+         *
+         * @param rowIndex
+         * @return field value
+         */
+        template <unsigned int I>
+        const column_type<I>& getField(long long rowIndex) const {
+            return std::get<I>(_columns)[rowIndex];
+        }
+
+        /**
+         * Method returns copy of the whole entry.
+         *
+         * @param rowIndex
+         * @return entry as std::tuple
+         */
+        csv_typedRow getRow(long long rowIndex) const {
+            csv_typedRow row;
+            RowCopier<0, _amountOfColumns>::copy(_columns, row, rowIndex);
+            return row;
+        }
+
+        void clear() {
+            ColumnReader<0, _amountOfColumns>::clear(_columns);
+            _amountOfEntries = 0;
+        }
+
+    private:
+        typedef std::tuple<std::vector<
+        typename CsvColumnTraits<Columns>::value_type>...> csv_typedColumns;
+
+        csv_typedColumns _columns;
+        long long _amountOfEntries = 0;
+
+        /**
+         * Compile time loop over columns I..N-1.
+         */
+        template <unsigned int I, unsigned int N>
+        struct ColumnReader {
+
+            static void read(csv_typedRow& typedRow,
+                    const CsvRowView& row, _errorHandlingMode errMode) {
+                try {
+                    std::get<I>(typedRow) =
+                            CsvColumnTraits<column_tag<I> >::convert(row, I);
+                } catch (UnableToConvertFieldTypeException&) {
+                    if (errMode != ignore_errors) throw;
+                    std::get<I>(typedRow) = column_type<I>();
+                }
+                ColumnReader<I + 1, N>::read(typedRow, row, errMode);
+            }
+
+            static void append(csv_typedColumns& columns,
+                    csv_typedRow& typedRow) {
+                std::get<I>(columns).push_back(std::move(std::get<I>(typedRow)));
+                ColumnReader<I + 1, N>::append(columns, typedRow);
+            }
+
+            static void clear(csv_typedColumns& columns) {
+                std::get<I>(columns).clear();
+                ColumnReader<I + 1, N>::clear(columns);
+            }
+        };
+
+        template <unsigned int N>
+        struct ColumnReader<N, N> {
+
+            static void read(csv_typedRow&,
+                    const CsvRowView&, _errorHandlingMode) {
+            }
+
+            static void append(csv_typedColumns&, csv_typedRow&) {
+            }
+
+            static void clear(csv_typedColumns&) {
+            }
+        };
+
+        template <unsigned int I, unsigned int N>
+        struct RowCopier {
+
+            static void copy(const csv_typedColumns& columns,
+                    csv_typedRow& row, long long rowIndex) {
+                std::get<I>(row) = std::get<I>(columns)[rowIndex];
+                RowCopier<I + 1, N>::copy(columns, row, rowIndex);
+            }
+        };
+
+        template <unsigned int N>
+        struct RowCopier<N, N> {
+
+            static void copy(const csv_typedColumns&,
+                    csv_typedRow&, long long) {
+            }
+        };
+    };
+}
+
+#endif /* CSVTYPEDTABLE_HPP */
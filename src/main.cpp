@@ -5,9 +5,51 @@
  * Author: dawidtoczek
  */
 #include "CsvHandler.hpp"
+#include "CsvTypedTable.hpp"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#ifdef CSVH_WITH_DESCRIPTORS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace csvh;
+
+static int failedChecks = 0;
+
+/**
+ * Prints result of a single check made by the examples.
+ */
+static void check(const string& description, bool passed) {
+    cout << (passed ? "OK: " : "FAILED: ") << description << endl;
+    if (!passed) ++failedChecks;
+}
+
+/**
+ * Source returning given text and failing on the next read,
+ * like a broken connection.
+ */
+class FailingSource : public CsvDataSource {
+public:
+
+    FailingSource(const string& text) : _text(text), _position(0) {
+    }
+
+    virtual long long read(char* data, long long size) override {
+        if (_position == _text.size()) throw runtime_error("Connection lost");
+        long long amount = min(size, (long long) (_text.size() - _position));
+        _text.copy(data, amount, _position);
+        _position += amount;
+        return amount;
+    }
+
+private:
+    string _text;
+    unsigned long _position;
+};
+
 int main() {
 
     // EXAMPLE 0a: Validate CSV file structure
@@ -154,5 +196,1054 @@ int main() {
         }
     }
 
-    return 0;
+    // EXAMPLE 7: Load memory-mapped file
+    {
+        CsvHandler mappedHandle("data/input/names.csv", load_mmap, CSV, ',', include_header);
+        CsvHandler copiedHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 7: Load memory-mapped file" << endl;
+        if (mappedHandle.loadEntries() && copiedHandle.loadEntries()) {
+            check("mapped file has the same entries",
+                    mappedHandle.getAmountOfEntries() == copiedHandle.getAmountOfEntries()
+                    && mappedHandle.getRow(3) == copiedHandle.getRow(3));
+            check("mapped file can be loaded again", mappedHandle.loadEntries()
+                    && mappedHandle.getAmountOfEntries() == copiedHandle.getAmountOfEntries());
+        }
+
+        bool missingFileReported = false;
+        try {
+            CsvHandler missingHandle("data/input/missing.csv", load_mmap, CSV, ',', include_header);
+            missingHandle.loadEntries();
+        } catch (UnableToOpenFileException& e) {
+            missingFileReported = true;
+        }
+        check("missing file is reported", missingFileReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 8: Use header probed at construction time
+    {
+        CsvHandler csvHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 8: Use header probed at construction time" << endl;
+        check("header is known before loading", csvHandle.getColumnId("Age") == 1);
+        check("entries are loaded after probing", csvHandle.loadEntries()
+                && csvHandle.getAmountOfEntries() == 8);
+        bool unknownCaptionReported = false;
+        try {
+            csvHandle.getColumnId("Address");
+        } catch (InvalidColumnCaptionException& e) {
+            unknownCaptionReported = true;
+        }
+        check("caption missing in probed header is reported", unknownCaptionReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 9: Read next chunk in background while current one is used
+    {
+        CsvHandler csvHandle("data/input/building_consents.csv", load_in_chunks, CSV, ',', include_header);
+        csvHandle.enableReadAhead();
+        long long amountOfEntries = 0;
+        bool buffersMeasured = true;
+
+        cout << "EXAMPLE 9: Read next chunk in background" << endl;
+        while (csvHandle.loadEntries()) {
+            amountOfEntries += csvHandle.getAmountOfEntries();
+            buffersMeasured = buffersMeasured
+                    && csvHandle.getMemoryUsage().readBuffers > 0;
+        }
+        check("all entries are read ahead", amountOfEntries == 5);
+        check("read buffers are measured while reading ahead", buffersMeasured);
+
+        ostringstream generated;
+        generated << "id,name\n";
+        for (int row = 0; row < 200000; ++row) generated << row << ",name " << row << '\n';
+        CsvHandler failingHandle(new FailingSource(generated.str()), load_in_chunks, CSV, ',', include_header);
+        failingHandle.enableReadAhead();
+        string readError;
+        try {
+            while (failingHandle.loadEntries());
+        } catch (runtime_error& e) {
+            readError = e.what();
+        }
+        check("read error of background thread is reported by loadEntries", readError == "Connection lost");
+        cout << endl;
+    }
+
+    // EXAMPLE 10: Size chunks by memory budget or by rows
+    {
+        CsvHandler budgetHandle("data/input/names_with_birthdate.csv", chunk_by_memory_budget, 1024 * 1024, CSV, ',', include_header);
+        CsvHandler rowsHandle("data/input/names_with_birthdate.csv", chunk_by_rows, 1000, CSV, ',', include_header);
+        long long budgetEntries = 0;
+        long long rowsEntries = 0;
+
+        cout << "EXAMPLE 10: Size chunks by memory budget or by rows" << endl;
+        while (budgetHandle.loadEntries()) budgetEntries += budgetHandle.getAmountOfEntries();
+        while (rowsHandle.loadEntries()) rowsEntries += rowsHandle.getAmountOfEntries();
+        check("all entries are loaded within memory budget", budgetEntries == 8);
+        check("all entries are loaded in chunks of rows", rowsEntries == 8);
+
+        CsvHandler tinyBudgetHandle("data/input/names_with_birthdate.csv", chunk_by_memory_budget, 1, CSV, ',', include_header);
+        CsvHandler singleRowHandle("data/input/names_with_birthdate.csv", chunk_by_rows, 1, CSV, ',', include_header);
+        long long tinyBudgetEntries = 0;
+        long long singleRowEntries = 0;
+        while (tinyBudgetHandle.loadEntries()) tinyBudgetEntries += tinyBudgetHandle.getAmountOfEntries();
+        while (singleRowHandle.loadEntries()) singleRowEntries += singleRowHandle.getAmountOfEntries();
+        check("budget smaller than a single row still loads all entries", tinyBudgetEntries == 8);
+        check("target of a single row per chunk still loads all entries", singleRowEntries == 8);
+        cout << endl;
+    }
+
+    // EXAMPLE 11: Read from std::istream and file descriptor
+    {
+        ifstream inStream("data/input/names.csv");
+        CsvHandler streamHandle(inStream, load_in_chunks, CSV, ',', include_header);
+
+        cout << "EXAMPLE 11: Read from std::istream and file descriptor" << endl;
+        check("entries are read from stream", streamHandle.loadEntries()
+                && streamHandle.getAmountOfEntries() == 8);
+#ifdef CSVH_WITH_DESCRIPTORS
+        int fileDescriptor = open("data/input/names.csv", O_RDONLY);
+        CsvHandler descriptorHandle(new CsvDescriptorSource(fileDescriptor), load_whole_file, CSV, ',', include_header);
+        check("entries are read from descriptor", descriptorHandle.loadEntries()
+                && descriptorHandle.getAmountOfEntries() == 8
+                && descriptorHandle.getRow(7) == streamHandle.getRow(7));
+        close(fileDescriptor);
+#endif
+
+        istringstream onceStream(string("Name,Age\nAnna,31\nPiotr,45\n"));
+        CsvHandler onceHandle(new CsvStreamSource(onceStream), load_whole_file, CSV, ',', include_header);
+        bool rewindReported = false;
+        onceHandle.loadEntries();
+        try {
+            onceHandle.loadEntries();
+        } catch (const UnableToRewindSourceException& exc) {
+            rewindReported = true;
+        }
+        check("loading non-seekable stream again is reported", rewindReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 12: Read gzip compressed file
+    {
+        CsvHandler plainHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        CsvHandler compressedHandle("data/input/names.csv.gz", load_mmap, CSV, ',', include_header);
+
+        cout << "EXAMPLE 12: Read gzip compressed file" << endl;
+        try {
+            plainHandle.loadEntries();
+            check("compressed file is decompressed while reading", compressedHandle.loadEntries()
+                    && compressedHandle.getRow(5) == plainHandle.getRow(5));
+            check("compressed file is decompressed again on next load", compressedHandle.loadEntries()
+                    && compressedHandle.getAmountOfEntries() == 8);
+        } catch (const UnsupportedCompressionException& exc) {
+            cout << exc.what() << endl;
+        }
+
+        bool corruptionReported = false;
+        try {
+            CsvHandler corruptedHandle("data/input/corrupted.csv.gz", load_whole_file, CSV, ',', include_header);
+            corruptedHandle.loadEntries();
+        } catch (const UnableToDecompressSourceException& exc) {
+            corruptionReported = true;
+        } catch (const UnsupportedCompressionException& exc) {
+            corruptionReported = true;
+        }
+        check("corrupted compressed file is reported", corruptionReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 13: Visit rows without loading them into storage
+    {
+        CsvHandler csvHandle("data/input/building_consents.csv", load_in_chunks, CSV, ',', include_header);
+        long long valuesSum = 0;
+
+        cout << "EXAMPLE 13: Visit rows without loading them" << endl;
+        long long visitedRows = csvHandle.forEachRow([&valuesSum](const CsvRowView & row) {
+            valuesSum += row.getInt(2);
+            return true;
+        });
+        check("all rows are visited", visitedRows == 5 && valuesSum == 2623 + 3494 + 2886 + 2948 + 2962);
+
+        CsvHandler stoppedHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+        long long stoppedRows = stoppedHandle.forEachRow([](const CsvRowView & row) {
+            return row.getRowIndex() < 1;
+        });
+        check("visiting stops when callback returns false", stoppedRows == 2);
+
+        CsvHandler convertedHandle("data/input/building_consents.csv", load_in_chunks, CSV, ',', include_header);
+        bool conversionReported = false;
+        try {
+            convertedHandle.forEachRow([](const CsvRowView & row) {
+                return row.getInt(0) >= 0;
+            });
+        } catch (const UnableToConvertFieldTypeException& exc) {
+            conversionReported = true;
+        }
+        check("field which is not a number is reported by the row", conversionReported);
+
+        CsvHandler indexedHandle("data/input/building_consents.csv", load_in_chunks, CSV, ',', include_header);
+        bool indexReported = false;
+        try {
+            indexedHandle.forEachRow([](const CsvRowView & row) {
+                return row.getString(row.getAmountOfColumns()).size() > 0;
+            });
+        } catch (const out_of_range& exc) {
+            indexReported = true;
+        }
+        check("column out of range is reported by the row", indexReported);
+
+        istringstream brokenStream(string("Name,Age\nAnna,31\nPiotr,45,extra\nEwa,28\n"));
+        CsvHandler brokenHandle(new CsvStreamSource(brokenStream), load_in_chunks, CSV, ',', include_header);
+        long long rowsBeforeError = 0;
+        bool splitReported = false;
+        try {
+            brokenHandle.forEachRow([&rowsBeforeError](const CsvRowView & row) {
+                ++rowsBeforeError;
+                return true;
+            });
+        } catch (const UnableToSplitEntryException& exc) {
+            splitReported = true;
+        }
+        check("entry with wrong number of fields stops visiting", splitReported && rowsBeforeError == 1);
+
+        istringstream skippedStream(string("Name,Age\nAnna,31\nPiotr,45,extra\nEwa,28\n"));
+        CsvHandler skippedHandle(new CsvStreamSource(skippedStream), load_in_chunks, CSV, ',', include_header);
+        ostringstream rejectStream;
+        CsvRejectLog rejectLog(rejectStream);
+        skippedHandle.setRejectSink(&rejectLog);
+        long long skippedRows = skippedHandle.forEachRow([](const CsvRowView & row) {
+            return true;
+        }, ignore_errors);
+        check("entry with wrong number of fields is skipped when errors are ignored", skippedRows == 2
+                && rejectStream.str().find("(expected 2 fields, found 3)") != string::npos);
+        cout << endl;
+    }
+
+    // EXAMPLE 14: Split quoted fields with every supported scanner kernel
+    {
+        _scannerImplementation defaultImplementation = CsvStructuralScanner::getImplementation();
+        vector<string> splitFields[3];
+
+        cout << "EXAMPLE 14: Split quoted fields with every scanner kernel" << endl;
+        for (int implementation = scanner_scalar; implementation <= scanner_avx2; ++implementation) {
+            if (!CsvStructuralScanner::useImplementation((_scannerImplementation) implementation)) continue;
+            CsvHandler csvHandle("data/input/quoted_fields.csv", load_in_chunks, CSV, ',', include_header);
+            vector<string>& fields = splitFields[implementation];
+            csvHandle.forEachRow([&fields](const CsvRowView & row) {
+                for (int column = 0; column < row.getAmountOfColumns(); ++column) {
+                    fields.push_back(row.getString(column).toString());
+                }
+                return true;
+            });
+        }
+        CsvStructuralScanner::useImplementation(defaultImplementation);
+
+        vector<string>& scalarFields = splitFields[scanner_scalar];
+        check("empty line is skipped and last line without line ending is kept", scalarFields.size() == 12);
+        check("delimiters inside quotes do not split fields", scalarFields.size() == 12
+                && scalarFields[5].find("crosses the 64 byte block boundary, twice") != string::npos
+                && scalarFields[11] == "\"last line, no line ending\"");
+        check("spaces around fields are trimmed", scalarFields.size() == 12 && scalarFields[1] == "Alice");
+        bool sameFields = true;
+        for (const vector<string>& fields : splitFields) {
+            sameFields = sameFields && (fields.empty() || fields == scalarFields);
+        }
+        check("vector kernels split fields as the scalar one", sameFields);
+        cout << endl;
+    }
+
+    // EXAMPLE 15: Parse a chunk on several threads
+    {
+        ostringstream generated;
+        generated << "id,group,name\n";
+        for (int row = 0; row < 300000; ++row) {
+            generated << row << ',' << row % 7 << ",name " << row << '\n';
+            if (row == 150000) generated << "1,2\n";
+        }
+        const string generatedText = generated.str();
+        string lastNames[2];
+        string rowsAfterReject[2];
+        long long amountOfEntries[2];
+        bool wrongEntryReported[2];
+
+        cout << "EXAMPLE 15: Parse a chunk on several threads" << endl;
+        for (int run = 0; run < 2; ++run) {
+            istringstream inStream(generatedText);
+            CsvHandler csvHandle(inStream, load_whole_file, CSV, ',', include_header);
+            CsvRejectCounter rejectCounter;
+            csvHandle.setRejectSink(&rejectCounter);
+            csvHandle.setParserThreads(run == 0 ? 1 : 4);
+            csvHandle.loadEntries(ignore_errors);
+            amountOfEntries[run] = csvHandle.getAmountOfEntries() + rejectCounter.getAmountOfRejected();
+            rowsAfterReject[run] = csvHandle.getField(0, 150001)->getStringValue();
+            lastNames[run] = csvHandle.getField(2, 299999)->getStringValue();
+
+            istringstream failingStream(generatedText);
+            CsvHandler failingHandle(failingStream, load_whole_file, CSV, ',', include_header);
+            failingHandle.setRejectSink(&rejectCounter);
+            failingHandle.setParserThreads(run == 0 ? 1 : 4);
+            try {
+                failingHandle.loadEntries();
+                wrongEntryReported[run] = false;
+            } catch (UnableToSplitEntryException& e) {
+                wrongEntryReported[run] = true;
+            }
+        }
+        check("rows keep their order when parsed by several threads", amountOfEntries[1] == 300001
+                && amountOfEntries[0] == amountOfEntries[1] && rowsAfterReject[1] == "150001"
+                && rowsAfterReject[0] == rowsAfterReject[1] && lastNames[0] == lastNames[1]);
+        check("wrong entry is reported by several threads", wrongEntryReported[0] && wrongEntryReported[1]);
+        cout << endl;
+    }
+
+    // EXAMPLE 16: Convert numbers without exceptions
+    {
+        const string number = " 42";
+        const string notNumber = "42abc";
+        const string tooLong = "99999999999";
+        const string exponent = "1.5e3";
+        int intValue = 0;
+        double doubleValue = 0;
+
+        cout << "EXAMPLE 16: Convert numbers without exceptions" << endl;
+        check("leading whitespace is skipped", CsvFieldParser::parseInt(number.data(),
+                number.data() + number.size(), intValue) == parse_ok && intValue == 42);
+        check("number followed by text is not an int", CsvFieldParser::parseInt(notNumber.data(),
+                notNumber.data() + notNumber.size(), intValue) == parse_type_not_correct);
+        check("too long integer is out of range", CsvFieldParser::parseInt(tooLong.data(),
+                tooLong.data() + tooLong.size(), intValue) == parse_out_of_range);
+        check("double with exponent is converted", CsvFieldParser::parseDouble(exponent.data(),
+                exponent.data() + exponent.size(), doubleValue) == parse_ok && doubleValue == 1500);
+
+        istringstream ignoringStream("id,price\n1,2.5\n2,abc\n3,1e3\n");
+        CsvHandler ignoringHandle(ignoringStream, load_whole_file, CSV, ',', include_header);
+        ignoringHandle.provideTypesForColumns(2, type_int, type_double);
+        check("field which is not a number is loaded as 0 when errors are ignored",
+                ignoringHandle.loadEntries(ignore_errors) && ignoringHandle.getAmountOfEntries() == 3
+                && ignoringHandle.getField(1, 1)->getStringValue() == "0");
+
+        istringstream stoppingStream("id,price\n1,2.5\n2,abc\n3,1e3\n");
+        CsvHandler stoppingHandle(stoppingStream, load_whole_file, CSV, ',', include_header);
+        stoppingHandle.provideTypesForColumns(2, type_int, type_double);
+        bool conversionReported = false;
+        try {
+            stoppingHandle.loadEntries(stop_on_error);
+        } catch (UnableToConvertFieldTypeException& e) {
+            conversionReported = string(e.what()).find("Field value: abc") != string::npos;
+        }
+        check("field which is not a number is reported on stop_on_error", conversionReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 17: Store dates as seconds since epoch in local time
+    {
+        CsvHandler csvHandle("data/input/names_with_birthdate.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.provideTypesForColumns(4, type_string, type_int, type_int, type_date);
+        std::tm birthdate = {};
+        birthdate.tm_year = 2008 - 1900;
+        birthdate.tm_mday = 1;
+        birthdate.tm_hour = 10;
+        birthdate.tm_min = 10;
+        birthdate.tm_sec = 10;
+        birthdate.tm_isdst = -1;
+
+        cout << "EXAMPLE 17: Store dates as seconds since epoch" << endl;
+        if (csvHandle.loadEntries()) {
+            csv_timeField* firstBirthdate = dynamic_cast<csv_timeField*>(csvHandle.getField(3, 0));
+            check("date is read as local time", firstBirthdate != nullptr
+                    && firstBirthdate->getValue() == std::mktime(&birthdate));
+            check("date is written back in its format",
+                    csvHandle.getField(3, 1)->getStringValue() == "2007-01-01 10:10:10");
+        }
+
+        CsvDateFormat dayFormat("%e.%m.%Y");
+        const string day = "5.03.2024";
+        std::time_t dayValue = 0;
+        check("%e day is space padded", dayFormat.parse(day.data(), day.data() + day.size(), dayValue) == parse_ok
+                && dayFormat.format(dayValue) == " 5.03.2024");
+
+        ostringstream spreadDates;
+        vector<std::time_t> expectedDates;
+        spreadDates << "id,created\n";
+        for (int row = 0; row < 20000; ++row) {
+            std::tm created = {};
+            created.tm_year = 1960 - 1900 + row * 7919 % 60;
+            created.tm_mon = row * 31 % 12;
+            created.tm_mday = 1 + row % 28;
+            created.tm_hour = 12;
+            created.tm_isdst = -1;
+            char text[32];
+            strftime(text, sizeof (text), "%Y-%m-%d %H:%M:%S", &created);
+            spreadDates << row << ',' << text << '\n';
+            expectedDates.push_back(std::mktime(&created));
+        }
+        istringstream spreadStream(spreadDates.str());
+        CsvHandler spreadHandle(spreadStream, load_whole_file, CSV, ',', include_header);
+        spreadHandle.provideTypesForColumns(2, type_int, type_date);
+        spreadHandle.setParserThreads(4);
+        bool sameDates = spreadHandle.loadEntries() && spreadHandle.getAmountOfEntries() == 20000;
+        CsvColumnSpan<std::time_t> parsedDates = spreadHandle.getDateColumn(1);
+        for (int row = 0; sameDates && row < 20000; ++row) {
+            sameDates = parsedDates[row] == expectedDates[row];
+        }
+        check("unsorted dates parsed by several threads are the same as with std::mktime", sameDates);
+
+        istringstream wrongDateStream("id,created\n1,2024-02-30 10:00:00\n");
+        CsvHandler wrongDateHandle(wrongDateStream, load_whole_file, CSV, ',', include_header);
+        wrongDateHandle.provideTypesForColumns(2, type_int, type_date);
+        bool wrongDateReported = false;
+        try {
+            wrongDateHandle.loadEntries();
+        } catch (UnableToConvertFieldTypeException& e) {
+            wrongDateReported = true;
+        }
+        check("date out of range is reported", wrongDateReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 18: Convert entries from the field tape reused between chunks
+    {
+        CsvHandler chunkedHandle("data/input/quoted_fields.csv", chunk_by_rows, 2, CSV, ',', include_header);
+        CsvHandler wholeHandle("data/input/quoted_fields.csv", load_whole_file, CSV, ',', include_header);
+        csv_entryLines chunkedRows;
+        bool tapesMeasured = true;
+
+        cout << "EXAMPLE 18: Convert entries from the field tape" << endl;
+        while (chunkedHandle.loadEntries()) {
+            for (int row = 0; row < chunkedHandle.getAmountOfEntries(); ++row) {
+                chunkedRows.push_back(chunkedHandle.getRow(row));
+            }
+            tapesMeasured = tapesMeasured && chunkedHandle.getMemoryUsage().fieldTapes > 0;
+        }
+        bool sameRows = wholeHandle.loadEntries()
+                && (long long) chunkedRows.size() == wholeHandle.getAmountOfEntries();
+        for (size_t row = 0; sameRows && row < chunkedRows.size(); ++row) {
+            sameRows = chunkedRows[row] == wholeHandle.getRow(row);
+        }
+        check("entries split into chunks are the same as loaded at once", sameRows);
+        check("quoted field is converted as a whole", chunkedRows.size() == 4
+                && chunkedRows[2].at(1) == "\"Carol \"\"C\"\" Smith\"");
+        check("field tapes are kept between chunks", tapesMeasured);
+
+        ostringstream generated;
+        generated << "name,age\n";
+        for (int row = 0; row < 50000; ++row) {
+            generated << "name " << row << ',' << row % 90 << (row == 40000 ? ",extra\n" : "\n");
+        }
+        istringstream skippedStream(generated.str());
+        CsvHandler skippedHandle(skippedStream, load_in_chunks, CSV, ',', include_header);
+        skippedHandle.setMemoryLimit(4 * 1024 * 1024);
+        ostringstream rejectStream;
+        CsvRejectLog rejectLog(rejectStream);
+        skippedHandle.setRejectSink(&rejectLog);
+        long long loadedEntries = 0;
+        int loadedChunks = 0;
+        while (skippedHandle.loadEntries(ignore_errors)) {
+            loadedEntries += skippedHandle.getAmountOfEntries();
+            ++loadedChunks;
+        }
+        check("wrong entry in later chunk is rejected with its line number", loadedChunks > 1
+                && loadedEntries == 49999 && rejectStream.str().find("Rejected line 40002 ") == 0);
+
+        istringstream stoppedStream(generated.str());
+        CsvHandler stoppedHandle(stoppedStream, load_in_chunks, CSV, ',', include_header);
+        stoppedHandle.setMemoryLimit(4 * 1024 * 1024);
+        bool wrongEntryReported = false;
+        try {
+            while (stoppedHandle.loadEntries()) {
+            }
+        } catch (const UnableToSplitEntryException& exc) {
+            wrongEntryReported = true;
+        }
+        check("wrong entry in later chunk is reported on stop_on_error", wrongEntryReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 19: Convert columns lazily, on first access
+    {
+        CsvHandler csvHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.enableLazyParsing();
+
+        cout << "EXAMPLE 19: Convert columns lazily" << endl;
+        if (csvHandle.loadEntries()) {
+            CsvMemoryUsage loadedUsage = csvHandle.getMemoryUsage();
+            check("columns are not converted by loadEntries", loadedUsage.columns.size() == 3
+                    && loadedUsage.columns[1].getTotal() == 0 && loadedUsage.fieldTapes > 0);
+            csv_column ageColumn = csvHandle.getColumn("Age");
+            CsvMemoryUsage accessedUsage = csvHandle.getMemoryUsage();
+            check("accessed column is converted", ageColumn.size() == 8
+                    && ageColumn[0]->getStringValue() == "23" && accessedUsage.columns[1].getTotal() > 0);
+            check("other columns stay on the tape", accessedUsage.columns[0].getTotal() == 0
+                    && accessedUsage.columns[2].getTotal() == 0);
+        }
+
+        istringstream wrongPriceStream("id,price\n1,2.5\n2,abc\n");
+        CsvHandler wrongPriceHandle(wrongPriceStream, load_whole_file, CSV, ',', include_header);
+        wrongPriceHandle.provideTypesForColumns(2, type_int, type_double);
+        wrongPriceHandle.enableLazyParsing();
+        bool wrongPriceReported = false;
+        bool correctColumnConverted = wrongPriceHandle.loadEntries()
+                && wrongPriceHandle.getColumn(0).size() == 2;
+        try {
+            wrongPriceHandle.getColumn(1);
+        } catch (UnableToConvertFieldTypeException& e) {
+            wrongPriceReported = true;
+        }
+        check("column without errors is converted", correctColumnConverted);
+        check("conversion error is reported by the accessing call", wrongPriceReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 20: Load only selected columns
+    {
+        CsvHandler csvHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.selectColumns(vector<string>{"Data_value", "Series_reference"});
+
+        cout << "EXAMPLE 20: Load only selected columns" << endl;
+        if (csvHandle.loadEntries()) {
+            csv_entryLine firstRow = csvHandle.getRow(0);
+            check("only selected columns are loaded, in selection order", firstRow.size() == 2
+                    && firstRow[0] == "2623" && firstRow[1] == "BLDM.SG000000001A0");
+            check("selected columns keep their captions", csvHandle.getColumnId("Series_reference") == 1
+                    && csvHandle.getMemoryUsage().columns.size() == 2);
+        }
+
+        CsvHandler wrongCaptionHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+        wrongCaptionHandle.selectColumns(vector<string>{"Missing"});
+        bool wrongCaptionReported = false;
+        try {
+            wrongCaptionHandle.loadEntries();
+        } catch (InvalidColumnCaptionException& e) {
+            wrongCaptionReported = true;
+        }
+        check("caption missing in header is reported", wrongCaptionReported);
+
+        CsvHandler wrongIndexHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+        wrongIndexHandle.selectColumns(vector<int>{1, 6});
+        bool wrongIndexReported = false;
+        try {
+            wrongIndexHandle.loadEntries();
+        } catch (std::out_of_range& e) {
+            wrongIndexReported = true;
+        }
+        check("column index behind the last column is reported", wrongIndexReported);
+        cout << endl;
+    }
+
+    // EXAMPLE 21: Filter rows while loading
+    {
+        CsvHandler csvHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.addRowFilter("Age", op_greater_equal, 40);
+        csvHandle.addRegexFilter("Full name", "^John");
+
+        cout << "EXAMPLE 21: Filter rows while loading" << endl;
+        check("only entries passing all filters are loaded", csvHandle.loadEntries()
+                && csvHandle.getAmountOfEntries() == 2
+                && csvHandle.getRow(0).at(0) == "John Gordon"
+                && csvHandle.getRow(1).at(0) == "John Matthews");
+
+        CsvHandler wrongCaptionHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        wrongCaptionHandle.addRowFilter("Missing", op_equal, 1);
+        string wrongCaptionMessage;
+        try {
+            wrongCaptionHandle.loadEntries();
+        } catch (InvalidColumnCaptionException& e) {
+            wrongCaptionMessage = e.what();
+        }
+        check("filter on caption missing in header is reported",
+                wrongCaptionMessage == "Column caption Missing is not valid.");
+        cout << endl;
+    }
+
+    // EXAMPLE 22: Detect column types from rows spread over the file
+    {
+        CsvHandler firstRowsHandle("data/input/measurements_cr.csv", load_whole_file, CSV, ',', include_header);
+        CsvHandler spreadHandle("data/input/measurements_cr.csv", load_whole_file, CSV, ',', include_header);
+        firstRowsHandle.setTypeDetectionSample(32, sample_first_rows);
+        spreadHandle.setTypeDetectionSample(32, sample_spread);
+
+        cout << "EXAMPLE 22: Detect column types from rows spread over the file" << endl;
+        bool firstRowsMisdetected = false;
+        try {
+            firstRowsHandle.loadEntries();
+        } catch (UnableToConvertFieldTypeException& e) {
+            firstRowsMisdetected = true;
+        }
+        check("doubles at the end of file are not seen in the first rows", firstRowsMisdetected);
+        check("spread sample widens int column to double in file with CR line endings",
+                spreadHandle.loadEntries() && spreadHandle.getDoubleColumn(1).size() == 2000);
+        cout << endl;
+    }
+
+    // EXAMPLE 23: Load entries into table with schema known at compile time
+    {
+        CsvHandler csvHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        TypedTable<std::string, int, int> people;
+
+        cout << "EXAMPLE 23: Load entries into typed table" << endl;
+        long long amountOfPeople = people.load(csvHandle);
+        long long agesSum = 0;
+        for (int age : people.getColumn<1>()) agesSum += age;
+        check("fields are converted to column types", amountOfPeople == 8
+                && people.getField<0>(2) == "John Matthews" && agesSum == 300);
+
+        CsvHandler widerHandle("data/input/names_with_birthdate.csv", load_whole_file, CSV, ',', include_header);
+        TypedTable<std::string, int, int> narrowTable;
+        bool wrongWidthReported = false;
+        try {
+            narrowTable.load(widerHandle);
+        } catch (UnableToSplitEntryException& e) {
+            wrongWidthReported = true;
+        }
+        check("entry with different number of columns is reported", wrongWidthReported);
+        check("entry with different number of columns is skipped when errors are ignored",
+                narrowTable.load(widerHandle, ignore_errors) == 0);
+
+        CsvHandler namesHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        TypedTable<int, int, int> numbersTable;
+        bool wrongTypeReported = false;
+        try {
+            numbersTable.load(namesHandle);
+        } catch (UnableToConvertFieldTypeException& e) {
+            wrongTypeReported = true;
+        }
+        check("field not matching column type is reported", wrongTypeReported);
+
+        istringstream laterErrorStream(string("id,age\n1,31\n2,abc\n"));
+        CsvHandler laterErrorHandle(laterErrorStream, load_whole_file, CSV, ',', include_header);
+        TypedTable<int, int> laterErrorTable;
+        try {
+            laterErrorTable.load(laterErrorHandle);
+        } catch (UnableToConvertFieldTypeException& e) {
+        }
+        check("columns keep the same size when later column is not converted",
+                laterErrorTable.getAmountOfEntries() == 1
+                && laterErrorTable.getColumn<0>().size() == 1
+                && laterErrorTable.getColumn<1>().size() == 1);
+        cout << endl;
+    }
+
+    // EXAMPLE 24: Read loaded columns as contiguous typed arrays
+    {
+        CsvHandler csvHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 24: Read loaded columns as typed arrays" << endl;
+        if (csvHandle.loadEntries()) {
+            CsvColumnSpan<int> values = csvHandle.getIntColumn(2);
+            long long valuesSum = 0;
+            for (long long row = 0; row < values.size(); ++row) valuesSum += values[row];
+            check("column is read as int array", values.size() == 5 && valuesSum == 14913);
+
+            bool wrongTypeReported = false;
+            try {
+                csvHandle.getDoubleColumn(2);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongTypeReported = true;
+            }
+            check("column read as other type is reported", wrongTypeReported);
+
+            csv_column textColumn;
+            for (int row = 0; row < csvHandle.getAmountOfEntries(); ++row) {
+                csv_stringField* textField = new csv_stringField();
+                textField->setValue("text");
+                textColumn.emplace_back(textField);
+            }
+            csvHandle.insertColumn(textColumn, "Declared int", type_int, 0);
+            bool wrongElementReported = false;
+            try {
+                csvHandle.getIntColumn(0);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongElementReported = true;
+            }
+            check("inserted element not matching column type is reported", wrongElementReported);
+            check("column with such element stays usable by element API",
+                    csvHandle.getField(0, 4)->getStringValue() == "text");
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 25: Release fields of a chunk at once
+    {
+        CsvHandler csvHandle("data/input/building_consents.csv", load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 25: Release fields of a chunk at once" << endl;
+        if (csvHandle.loadEntries()) {
+            size_t firstLoadElements = csvHandle.getColumn(0).size();
+            long long firstLoadMemory = csvHandle.getMemoryUsage().cellObjects;
+
+            csv_column notesColumn;
+            for (int row = 0; row < csvHandle.getAmountOfEntries(); ++row) {
+                csv_stringField* noteField = new csv_stringField();
+                noteField->setValue("note long enough to be kept on the heap " + to_string(row));
+                notesColumn.emplace_back(noteField);
+            }
+            csvHandle.insertColumn(notesColumn, "Notes", type_string, 0);
+            csvHandle.removeRow(1);
+            check("fields passed by user are released with removed rows",
+                    csvHandle.getColumn(0).size() == 4
+                    && csvHandle.getField(0, 1)->getStringValue() == "note long enough to be kept on the heap 2");
+
+            csv_column extraColumn(1, new csv_stringField());
+            bool wrongPositionReported = false;
+            try {
+                csvHandle.insertColumn(extraColumn, "Extra", type_string, 100);
+            } catch (const out_of_range& exc) {
+                wrongPositionReported = true;
+            }
+            // Fields of the rejected column are still owned by the caller.
+            for (csv_genericField field : extraColumn) delete field;
+            check("column behind the last one is reported and not taken over", wrongPositionReported
+                    && csvHandle.getColumn(0).size() == 4);
+
+            while (csvHandle.getAmountOfEntries() > 0) csvHandle.removeRow(0);
+            check("every field is released when all rows are removed", csvHandle.getColumn(0).empty());
+
+            csvHandle.loadEntries();
+            check("arena memory is reused by the next load", csvHandle.getColumn(0).size() == firstLoadElements
+                    && csvHandle.getMemoryUsage().cellObjects == firstLoadMemory);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 26: Search dictionary encoded column
+    {
+        const string statuses[] = {"open", "pending", "closed"};
+        ostringstream generated;
+        generated << "id,status\n";
+        for (int row = 0; row < 300; ++row) generated << row << ',' << statuses[row % 3] << '\n';
+        istringstream inStream(generated.str());
+        CsvHandler csvHandle(inStream, load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 26: Search dictionary encoded column" << endl;
+        if (csvHandle.loadEntries()) {
+            csvHandle.removeRow(0);
+            csv_column found = csvHandle.findAll("status", "^open$|^closed$");
+            bool sameValues = found.size() == 199;
+            for (CsvEntryElement* field : found) {
+                sameValues = sameValues && (field->getStringValue() == "open"
+                        || field->getStringValue() == "closed");
+            }
+            check("matching fields of not removed rows are found", sameValues);
+            check("column stays dictionary encoded", csvHandle.getColumnStore(1).isDictionaryEncoded()
+                    && csvHandle.getColumnStore(1).getDictionarySize() == 3);
+            try {
+                csvHandle.findAll(2, "open");
+                check("column out of range is reported", false);
+            } catch (const std::out_of_range& e) {
+                check("column out of range is reported", true);
+            }
+
+            long long replaced = csvHandle.replaceAll("status", "^pending$", "open");
+            check("value replaced with existing one is kept once", replaced == 100
+                    && csvHandle.getColumnStore(1).getDictionarySize() == 2
+                    && csvHandle.findAll("status", "^open$").size() == 199);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 27: Keep dates apart from 64-bit integers
+    {
+        CsvHandler tableHandle("data/input/names_with_birthdate.csv", load_whole_file, CSV, ',', include_header);
+        TypedTable<std::string, long long, int, CsvDate> people;
+        std::tm birthdate = {};
+        birthdate.tm_year = 2008 - 1900;
+        birthdate.tm_mday = 1;
+        birthdate.tm_hour = 10;
+        birthdate.tm_min = 10;
+        birthdate.tm_sec = 10;
+        birthdate.tm_isdst = -1;
+
+        cout << "EXAMPLE 27: Keep dates apart from 64-bit integers" << endl;
+        check("date and int64 columns have their own types",
+                TypedTable<long long, CsvDate>::getColumnType<0>() == type_int64
+                && TypedTable<long long, CsvDate>::getColumnType<1>() == type_date);
+        check("date column of typed table is read as date", people.load(tableHandle) == 8
+                && people.getField<3>(0) == std::mktime(&birthdate));
+
+        CsvHandler csvHandle("data/input/names_with_birthdate.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.provideTypesForColumns(4, type_string, type_int64, type_int, type_date);
+        if (csvHandle.loadEntries()) {
+            CsvColumnSpan<std::time_t> dates = csvHandle.getDateColumn(3);
+            check("stored date column is not narrowed", dates[0] == std::mktime(&birthdate)
+                    && csvHandle.getColumnStore(3).getIntegerWidth() == 0);
+            bool wrongTypeReported = false;
+            try {
+                csvHandle.getInt64Column(3);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongTypeReported = true;
+            }
+            check("date column is not read as int64", wrongTypeReported);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 28: Remove rows without converting lazy columns
+    {
+        CsvHandler csvHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        csvHandle.enableLazyParsing();
+
+        cout << "EXAMPLE 28: Remove rows without converting lazy columns" << endl;
+        if (csvHandle.loadEntries()) {
+            csvHandle.removeRow(0);
+            csvHandle.removeRow(1);
+            CsvColumnSpan<int> ages = csvHandle.getIntColumn(1);
+            CsvMemoryUsage usage = csvHandle.getMemoryUsage();
+            check("accessed column is compacted", ages.size() == 6 && ages[0] == 54 && ages[1] == 46);
+            check("other columns stay on the tape", usage.columns[0].getTotal() == 0
+                    && usage.columns[2].getTotal() == 0);
+            check("column left on the tape skips removed rows", csvHandle.getAmountOfEntries() == 6
+                    && csvHandle.getField(0, 1)->getStringValue() == "Oliver Graham");
+
+            csvHandle.removeRow(0);
+            csvHandle.insertColumn(type_int);
+            check("inserted column has entry for every row left", csvHandle.getColumn(3).size() == 5
+                    && csvHandle.getField(0, 0)->getStringValue() == "Oliver Graham");
+        }
+
+        istringstream wrongPriceStream("id,price\n1,2.5\n2,abc\n3,4.5\n");
+        CsvHandler wrongPriceHandle(wrongPriceStream, load_whole_file, CSV, ',', include_header);
+        wrongPriceHandle.provideTypesForColumns(2, type_int, type_double);
+        wrongPriceHandle.enableLazyParsing();
+        if (wrongPriceHandle.loadEntries()) {
+            wrongPriceHandle.removeRow(0);
+            bool wrongPriceReported = false;
+            try {
+                wrongPriceHandle.getDoubleColumn(1);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongPriceReported = true;
+            }
+            check("conversion error of row left is reported", wrongPriceReported);
+            wrongPriceHandle.removeRow(0);
+            check("removed row is not converted", wrongPriceHandle.getDoubleColumn(1).size() == 1
+                    && wrongPriceHandle.getDoubleColumn(1)[0] == 4.5);
+        }
+
+        CsvHandler filteredHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        filteredHandle.enableLazyParsing();
+        if (filteredHandle.loadEntries()) {
+            long long removedRows = filteredHandle.removeRows({1}, [](const CsvRowView & row) {
+                return row.getInt(0) > 45;
+            });
+            CsvMemoryUsage usage = filteredHandle.getMemoryUsage();
+            check("rows are removed by predicate without converting columns", removedRows == 3
+                    && usage.columns[0].getTotal() == 0 && usage.columns[1].getTotal() == 0
+                    && usage.columns[2].getTotal() == 0);
+
+            filteredHandle.getIntColumn(1);
+            removedRows = filteredHandle.removeRows({2, 1}, [](const CsvRowView & row) {
+                return row.getInt(1) < 20 || row.getString(1).toString() == "21";
+            });
+            check("predicate reads converted column by index given", removedRows == 3
+                    && filteredHandle.getAmountOfEntries() == 2
+                    && filteredHandle.getField(0, 1)->getStringValue() == "John Matthews");
+
+            bool wrongColumnReported = false;
+            try {
+                filteredHandle.removeRows({3}, [](const CsvRowView&) {
+                    return true;
+                });
+            } catch (out_of_range& e) {
+                wrongColumnReported = true;
+            }
+            check("invalid column of predicate is reported", wrongColumnReported
+                    && filteredHandle.getAmountOfEntries() == 2);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 29: Insert row in the middle of a chunk
+    {
+        ostringstream generated;
+        generated << "name,age\n";
+        for (int row = 0; row < 50000; ++row) generated << "name " << row << ',' << row % 90 << '\n';
+        istringstream inStream(generated.str());
+        CsvHandler csvHandle(inStream, load_in_chunks, CSV, ',', include_header);
+        csvHandle.setMemoryLimit(4 * 1024 * 1024);
+
+        cout << "EXAMPLE 29: Insert row in the middle of a chunk" << endl;
+        long long firstChunkEntries = csvHandle.loadEntries() ? csvHandle.getAmountOfEntries() : 0;
+        if (csvHandle.loadEntries()) {
+            long long secondChunkEntries = csvHandle.getAmountOfEntries();
+            int insertPos = firstChunkEntries + 1;
+            csvHandle.insertRow("Anna Smith,30", insertPos);
+            check("row is inserted at its position in file", secondChunkEntries > 1
+                    && csvHandle.getAmountOfEntries() == secondChunkEntries + 1
+                    && csvHandle.getRow(insertPos)[0] == "Anna Smith"
+                    && csvHandle.getRow(insertPos + 1)[0] == "name " + std::to_string(insertPos));
+            bool wrongRowReported = false;
+            try {
+                csvHandle.insertRow("Anna Smith,abc", insertPos);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongRowReported = true;
+            }
+            check("field not matching column type is reported", wrongRowReported);
+        }
+
+        CsvHandler wholeHandle("data/input/names.csv", load_whole_file, CSV, ',', include_header);
+        if (wholeHandle.loadEntries()) {
+            bool wrongPositionReported = false;
+            try {
+                wholeHandle.insertRow("Anna Smith,30,55540000", 100);
+            } catch (std::out_of_range& e) {
+                wrongPositionReported = true;
+            }
+            check("position behind the last row is reported", wrongPositionReported);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 30: Insert rows and columns into typed arrays
+    {
+        const string statuses[] = {"open", "closed"};
+        ostringstream generated;
+        generated << "id,status\n";
+        for (int row = 0; row < 64; ++row) generated << row << ',' << statuses[row % 2] << '\n';
+        istringstream inStream(generated.str());
+        CsvHandler csvHandle(inStream, load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 30: Insert rows and columns into typed arrays" << endl;
+        if (csvHandle.loadEntries()) {
+            csvHandle.insertRow("100000,pending", 1);
+            csvHandle.insertRow("65,open");
+            CsvColumnSpan<int> ids = csvHandle.getIntColumn(0);
+            const CsvColumnStore& statusStore = csvHandle.getColumnStore(1);
+            check("row is inserted into typed arrays", ids.size() == 66 && ids[1] == 100000
+                    && ids[2] == 1 && ids[65] == 65 && statusStore.getString(1) == CsvStringSlice("pending")
+                    && statusStore.getString(2) == CsvStringSlice("closed"));
+            check("no field objects are created", csvHandle.getMemoryUsage().cellObjects == 0);
+            check("string column stays dictionary encoded", statusStore.isDictionaryEncoded()
+                    && statusStore.getDictionarySize() == 3);
+
+            bool wrongRowReported = false;
+            try {
+                csvHandle.insertRow("abc,open", 1);
+            } catch (UnableToConvertFieldTypeException& e) {
+                wrongRowReported = true;
+            }
+            check("wrong row is reported and no column is changed", wrongRowReported
+                    && csvHandle.getAmountOfEntries() == 66 && csvHandle.getIntColumn(0).size() == 66
+                    && csvHandle.getColumnStore(1).size() == 66);
+
+            csvHandle.insertColumn(type_double, 1);
+            check("inserted column is kept in typed array", csvHandle.getDoubleColumn(1).size() == 66
+                    && !csvHandle.getColumnStore(1).isSet(0) && csvHandle.getIntColumn(0)[1] == 100000
+                    && csvHandle.getMemoryUsage().cellObjects == 0);
+        }
+        cout << endl;
+    }
+
+    // EXAMPLE 31: Report rejected lines once per load
+    {
+        ostringstream generated;
+        generated << "name,age\n";
+        for (int row = 0; row < 100000; ++row) {
+            generated << "name " << row << ',' << row % 90;
+            if (row % 1000 == 1) generated << ",extra";
+            generated << '\n';
+        }
+        const string generatedText = generated.str();
+        istringstream inStream(generatedText);
+        CsvHandler csvHandle(inStream, load_in_chunks, CSV, ',', include_header);
+        csvHandle.setMemoryLimit(4 * 1024 * 1024);
+        ostringstream rejectStream;
+        CsvRejectLog rejectLog(rejectStream, 2);
+        csvHandle.setRejectSink(&rejectLog);
+
+        cout << "EXAMPLE 31: Report rejected lines once per load" << endl;
+        int chunks = 0;
+        while (csvHandle.loadEntries(ignore_errors)) ++chunks;
+        const string rejected = rejectStream.str();
+        const string summary = "98 more rejected lines not logged";
+        check("rest of rejected lines is summarized once", chunks > 1
+                && rejected.find("Rejected line 3 ") == 0 && rejected.find(summary) != string::npos
+                && rejected.find(summary) == rejected.rfind(summary));
+
+        istringstream failingStream(generatedText);
+        CsvHandler failingHandle(failingStream, load_whole_file, CSV, ',', include_header);
+        ostringstream errorStream;
+        std::streambuf* errorBuffer = cerr.rdbuf(errorStream.rdbuf());
+        string errorMessage;
+        try {
+            failingHandle.loadEntries();
+        } catch (UnableToSplitEntryException& e) {
+            errorMessage = e.what();
+        }
+        cerr.rdbuf(errorBuffer);
+        check("entry with wrong number of fields is reported by exception only",
+                errorMessage.find("(expected 2 fields, found 3)") != string::npos && errorStream.str().empty());
+        cout << endl;
+    }
+
+    // EXAMPLE 32: Keep mapped and chunked loads within memory limit
+    {
+        CsvHandler mappedHandle("data/input/names.csv", load_mmap, CSV, ',', include_header);
+        mappedHandle.setMemoryLimit(100);
+
+        cout << "EXAMPLE 32: Keep mapped and chunked loads within memory limit" << endl;
+        bool mappedLimitReported = false;
+        try {
+            mappedHandle.loadEntries();
+        } catch (MemoryLimitExceededException& e) {
+            mappedLimitReported = true;
+        }
+        check("mapped file larger than limit is reported", mappedLimitReported);
+        mappedHandle.setMemoryLimit(1024 * 1024);
+        check("mapped file within limit is loaded", mappedHandle.loadEntries()
+                && mappedHandle.getAmountOfEntries() == 8);
+
+        ostringstream generated;
+        generated << "name,age\n";
+        for (int row = 0; row < 100000; ++row) generated << "name " << row << ',' << row % 90 << '\n';
+        istringstream inStream(generated.str());
+        const long long memoryLimit = 4 * 1024 * 1024;
+        CsvHandler csvHandle(inStream, load_in_chunks, CSV, ',', include_header);
+        csvHandle.setMemoryLimit(memoryLimit);
+        int chunks = 0;
+        long long amountOfEntries = 0;
+        bool withinLimit = true;
+        while (csvHandle.loadEntries()) {
+            ++chunks;
+            amountOfEntries += csvHandle.getAmountOfEntries();
+            withinLimit = withinLimit && csvHandle.getMemoryUsage().getTotal() <= memoryLimit;
+        }
+        check("chunks are shrunk to fit the limit", chunks > 1 && amountOfEntries == 100000 && withinLimit);
+        cout << endl;
+    }
+
+    // EXAMPLE 33: Insert rows into loaded columns kept in row groups
+    {
+        ostringstream generated;
+        generated << "id,name,price\n";
+        for (int row = 0; row < 500000; ++row) generated << row << ",name " << row << ',' << row % 1000 << ".5\n";
+        istringstream inStream(generated.str());
+        CsvHandler csvHandle(inStream, load_whole_file, CSV, ',', include_header);
+
+        cout << "EXAMPLE 33: Insert rows into loaded columns kept in row groups" << endl;
+        if (csvHandle.loadEntries()) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (int row = 0; row < 1000; ++row) {
+                csvHandle.insertRow(to_string(1000000 + row) + ",inserted " + to_string(row) + ",1.25", 250000);
+            }
+            double insertSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "1000 rows inserted in the middle of 500000 in " << insertSeconds << " s" << endl;
+            check("rows inserted in the middle shift one row group only", insertSeconds < 1.0);
+            check("inserted rows are read from row groups", csvHandle.getAmountOfEntries() == 501000
+                    && csvHandle.getRow(250000)[1] == "inserted 999"
+                    && csvHandle.getRow(250999)[0] == "1000000"
+                    && csvHandle.getRow(251000)[1] == "name 250000"
+                    && csvHandle.getRow(500999)[2] == "999.5");
+
+            CsvColumnSpan<int> ids = csvHandle.getIntColumn(0);
+            check("row groups are merged into one array", ids.size() == 501000
+                    && ids[250000] == 1000999 && ids[251000] == 250000 && ids[500999] == 499999);
+            csvHandle.insertRow("-1,first,0.5", 0);
+            check("row is inserted after column is merged", csvHandle.getRow(0)[1] == "first"
+                    && csvHandle.getDoubleColumn(2).size() == 501001
+                    && csvHandle.getDoubleColumn(2)[250001] == 1.25);
+        }
+        cout << endl;
+    }
+
+    return failedChecks == 0 ? 0 : 1;
 }